@@ -0,0 +1,153 @@
+#include "bench.h"
+
+#include <deque>
+#include <random>
+
+#include "linkadapter.h"
+
+// Канал на петле в миллисекундах: задержка в одну сторону, потери в обе стороны,
+// получатель разбирает не больше capacity команд в секунду (0 - без ограничения)
+struct LinkScenario
+{
+    const char* name;
+    int delayMs;
+    double loss;
+    double capacity;
+};
+
+static const LinkScenario Scenarios[] = {
+    {"lan", 1, 0.0, 0},
+    {"tether", 20, 0.1, 0},
+    {"acoustic", 250, 0.2, 4},
+};
+static const int Seconds = 120;
+static const int Reported[] = {1, 2, 5, 10, 20, 40, 80, 120};
+
+struct InFlight
+{
+    int at;                         // Когда придет, мс
+    int sent;                       // Когда отправлена, мс
+};
+
+// Неизменная команда, которую отсев повторяет только по keepalive или при смене
+// time_limit; аппарат останавливается, если за time_limit последней пришедшей
+// копии не пришла следующая
+struct SteadyCommand
+{
+    int lastSend = -1000000;
+    int sentLimit = 0;
+    int arrival = 0;
+    int limit = 0;                  // time_limit последней пришедшей копии, мс
+    bool stopped = false;
+    int stops = 0;
+    std::deque<InFlight> forward;   // sent - time_limit копии, мс
+
+    // Вызывается на такте отправки
+    void Send(int t, double period, double timeLimit, bool delivered, int delayMs)
+    {
+        int limitMs = static_cast<int>(timeLimit * 1000 + 0.5);
+        if (limitMs == sentLimit && t - lastSend < static_cast<int>(period * 1000 + 0.5)) {
+            return;
+        }
+        if (delivered) {
+            forward.push_back({t + delayMs, limitMs});
+        }
+        lastSend = t;
+        sentLimit = limitMs;
+    }
+
+    void Receive(int t)
+    {
+        while (!forward.empty() && forward.front().at <= t) {
+            arrival = forward.front().at;
+            limit = forward.front().sent;
+            stopped = false;
+            forward.pop_front();
+        }
+        if (!stopped && limit > 0 && t - arrival > limit) {
+            stopped = true;
+            stops++;
+        }
+    }
+};
+
+// Прежний повтор: time_limit за вычетом постоянного запаса
+static const double KeepaliveMargin = 0.5;
+
+static void RunScenario(const LinkScenario& link)
+{
+    std::minstd_rand random(3);
+    std::uniform_real_distribution<double> chance(0.0, 1.0);
+
+    LinkAdapter adapter;
+    adapter.Configure(LinkAdapterSettings(), 0.1, 2.0);
+
+    std::deque<InFlight> forward;   // Команды в пути
+    std::deque<int> queue;          // Пришли, ждут разбора: время отправки
+    std::deque<InFlight> acks;      // Подтверждения в пути
+    int nextSend = 0;
+    int nextServe = 0;
+    int sent = 0, lost = 0, queueMax = 0;
+    int report = 0;
+    SteadyCommand adapted, margin;
+
+    printf("adapt: %s, %d ms one way, loss %.2f, capacity %.0f/s\n",
+           link.name, link.delayMs, link.loss, link.capacity);
+    for (int t = 0; t < Seconds * 1000; t++) {
+        if (t >= nextSend) {
+            sent++;
+            if (chance(random) >= link.loss) {
+                forward.push_back({t + link.delayMs, t});
+            }
+            else {
+                lost++;
+            }
+            nextSend = t + static_cast<int>(adapter.Interval() * 1000 + 0.5);
+            adapted.Send(t, adapter.Keepalive(), adapter.TimeLimit(), chance(random) >= link.loss, link.delayMs);
+            margin.Send(t, adapter.TimeLimit() - KeepaliveMargin, adapter.TimeLimit(),
+                        chance(random) >= link.loss, link.delayMs);
+        }
+        while (!forward.empty() && forward.front().at <= t) {
+            queue.push_back(forward.front().sent);
+            forward.pop_front();
+        }
+        while (!queue.empty() && (link.capacity == 0 || t >= nextServe)) {
+            if (chance(random) >= link.loss) {
+                acks.push_back({t + link.delayMs, queue.front()});
+            }
+            queue.pop_front();
+            if (link.capacity > 0) {
+                nextServe = t + static_cast<int>(1000 / link.capacity);
+            }
+        }
+        queueMax = std::max(queueMax, static_cast<int>(queue.size()));
+        adapted.Receive(t);
+        margin.Receive(t);
+        while (!acks.empty() && acks.front().at <= t) {
+            adapter.RttSample((t - acks.front().sent) / 1000.0);
+            acks.pop_front();
+        }
+
+        if ((t + 1) % 1000 == 0) {
+            adapter.Update(sent > 0 ? static_cast<double>(lost) / sent : 0.0, queueMax);
+            int second = (t + 1) / 1000;
+            if (second == Reported[report]) {
+                printf("adapt:   %3d s  interval %5.3f s  time_limit %5.2f s  keepalive %5.3f s  rtt %6.3f s  "
+                       "queue %3d%s\n",
+                       second, adapter.Interval(), adapter.TimeLimit(), adapter.Keepalive(), adapter.Rtt(), queueMax,
+                       adapter.IsCongested() ? "  congested" : "");
+                report++;
+            }
+            sent = lost = queueMax = 0;
+        }
+    }
+    printf("adapt:   steady command stopped %d times with keepalive, %d times with time_limit - %.1f s\n",
+           adapted.stops, margin.stops, KeepaliveMargin);
+}
+
+void RunAdaptBench()
+{
+    for (const LinkScenario& link : Scenarios) {
+        RunScenario(link);
+    }
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+
+// Замеры производительности модулей драйвера без геймпада и шины.
+
+class BenchTimer
+{
+public:
+    BenchTimer() : start(std::chrono::steady_clock::now()) {}
+
+    double Seconds() const
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+private:
+    std::chrono::steady_clock::time_point start;
+};
+
+// Не дает компилятору выбросить результат замера
+extern volatile float benchSink;
+
+void RunMappingBench();
+void RunFixedBench();
+void RunPredictorBench();
+void RunDispatchBench();
+void RunStaticBench();
+void RunExpressionBench();
+void RunBundleBench();
+void RunFrameBench();
+void RunRedundantBench();
+void RunCriticalBench();
+void RunLoopBench();
+void RunAdaptBench();
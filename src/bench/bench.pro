@@ -0,0 +1,68 @@
+TEMPLATE = app
+CONFIG += console c++11
+CONFIG -= app_bundle                 # Не собирать маковский архив
+CONFIG -= qt
+QT -= gui
+QT -= core
+DESTDIR = ../../bin                  # Папка с бинарниками проекта
+OBJECTS_DIR = $$PWD/build            # Путь объектников
+TARGET = bench
+
+# Замеры собираются с векторными расширениями целевой машины
+QMAKE_CXXFLAGS_RELEASE += -O2 -march=native
+
+SOURCES += \
+    adaptbench.cpp \
+    bundlebench.cpp \
+    criticalbench.cpp \
+    dispatchbench.cpp \
+    expressionbench.cpp \
+    main.cpp \
+    fixedbench.cpp \
+    framebench.cpp \
+    loopbench.cpp \
+    mappingbench.cpp \
+    predictorbench.cpp \
+    redundantbench.cpp \
+    staticbench.cpp \
+    ../driver/axisaccumulator.cpp \
+    ../driver/commanddispatch.cpp \
+    ../driver/commands.cpp \
+    ../driver/controlbundle.cpp \
+    ../driver/controldedup.cpp \
+    ../driver/controlframe.cpp \
+    ../driver/criticaldelivery.cpp \
+    ../driver/expression.cpp \
+    ../driver/fixedmapping.cpp \
+    ../driver/latencyhistogram.cpp \
+    ../driver/linkadapter.cpp \
+    ../driver/looplatency.cpp \
+    ../driver/mapping.cpp \
+    ../driver/predictor.cpp \
+    ../driver/sequencetracker.cpp
+
+HEADERS += \
+    bench.h
+
+win32 {
+    # Путь до библиотеки SDL (разбор имен кнопок и осей в commands.cpp):
+    SDL2_PATH = "..\..\lib\SDL2-2.26.4\i686-w64-mingw32"
+
+    # Путь до библиотеки IPC:
+    IPC_LIB_PATH = "..\..\lib\ipc_lib\win32\usr"
+
+    # Сокеты для замера UDP через 127.0.0.1
+    LIBS += -lws2_32
+}
+
+linux-g++ {
+    # Путь до библиотеки IPC:
+    IPC_LIB_PATH = "..\..\lib\ipc_lib\linux\usr"
+}
+
+INCLUDEPATH += \
+    ..\driver \
+    $${SDL2_PATH}\include \
+    $${IPC_LIB_PATH}\include
+LIBS += \
+    -L$${SDL2_PATH}\lib -lSDL2
@@ -0,0 +1,75 @@
+#include "bench.h"
+
+#include <cmath>
+
+#include "controlbundle.h"
+
+static const double Seconds = 20.0;
+static const double Rates[] = {200.0, 500.0, 1000.0};
+static const int Sizes[] = {1, 4, 8, 16, 32};
+
+// Заголовок пакета без массива отсчетов: столько занимает пакет, если слать только заполненную часть
+static const size_t HeaderBytes = sizeof(Message::ControlBundle) - sizeof(Message::ControlBundle::samples);
+
+// Отсчеты идут на частоте rate по виртуальному времени; пакет доставляется в момент заполнения.
+// К задержке добавляется измеренное время упаковки и разбора одного пакета.
+static void RunBundle(double rate, int size)
+{
+    ControlBundler bundler;
+    bundler.Configure(size);
+    ControlUnbundler unbundler;
+    Message::ControlBundle bundle;
+
+    motion::Control control;
+    for (int i = 0; i < geo::Num; i++) {
+        control.parameters[i].type = motion::ControlType::Force;
+        control.parameters[i].frame = scene::Absent;
+    }
+    control.time_limit = 2;
+
+    int samples = static_cast<int>(rate * Seconds);
+    double period = 1e6 / rate;
+    double latencySum = 0;
+    double latencyMax = 0;
+    uint64_t delivered = 0;
+    int bundles = 0;
+    uint64_t flushTime = 0;
+
+    BenchTimer timer;
+    for (int i = 0; i < samples; i++) {
+        uint64_t timestamp = static_cast<uint64_t>(i * period) + 1;
+        control.parameters[geo::Forward].value = std::sin(i * 0.01);
+        bundler.Add(control, timestamp);
+        if (!bundler.IsFull()) {
+            continue;
+        }
+        bundler.Flush(bundle);
+        bundles++;
+        flushTime = timestamp;
+        delivered += unbundler.Unpack(bundle, [&](const motion::Control& c, uint64_t stamp) {
+            double latency = static_cast<double>(flushTime - stamp);
+            latencySum += latency;
+            latencyMax = latency > latencyMax ? latency : latencyMax;
+            benchSink = benchSink + static_cast<float>(c.parameters[geo::Forward].value);
+        });
+    }
+    double processing = timer.Seconds() * 1e6 / (bundles > 0 ? bundles : 1);
+
+    double perSecond = bundles / Seconds;
+    double payload = perSecond * (HeaderBytes + size * sizeof(Message::ControlSample));
+    double full = perSecond * sizeof(Message::ControlBundle);
+    double mean = (delivered > 0 ? latencySum / delivered : 0) + processing;
+    printf("bundle: %4.0f Hz x %2d  %6.1f msg/s  payload %7.0f B/s  message %7.0f B/s  "
+           "latency mean %7.1f us  max %7.1f us\n",
+           rate, size, perSecond, payload, full, mean, latencyMax + processing);
+}
+
+void RunBundleBench()
+{
+    for (double rate : Rates) {
+        printf("bundle: %4.0f Hz baseline motion::Control %7.0f B/s\n", rate, rate * sizeof(motion::Control));
+        for (int size : Sizes) {
+            RunBundle(rate, size);
+        }
+    }
+}
@@ -0,0 +1,67 @@
+#include "bench.h"
+
+#include <random>
+
+#include "criticaldelivery.h"
+
+static const int Stops = 100000;
+static const uint32_t RoundTripMs = 4;
+static const double Losses[] = {0.01, 0.1, 0.3};
+static const int Bursts[] = {1, 3};
+
+// Виртуальные миллисекунды: копия и подтверждение теряются независимо с долей loss
+static void RunCritical(double loss, int burst)
+{
+    CriticalSettings settings;
+    settings.burst = burst;
+    std::minstd_rand random(11);
+    std::uniform_real_distribution<double> chance(0.0, 1.0);
+
+    CriticalDelivery delivery;
+    delivery.Configure(settings);
+
+    int failed = 0;
+    uint64_t ackSum = 0;
+    uint32_t ackMax = 0;
+    uint64_t retrySum = 0;
+    for (int i = 0; i < Stops; i++) {
+        uint32_t sequence = static_cast<uint32_t>(i + 1);
+        delivery.Start(sequence, 0);
+        uint32_t ackAt = UINT32_MAX;
+        for (uint32_t now = 0; delivery.IsPending(); now++) {
+            if (now >= ackAt) {
+                delivery.Acknowledge(sequence, now);
+                break;
+            }
+            int copies = delivery.Due(now);
+            for (int c = 0; c < copies; c++) {
+                bool arrived = chance(random) >= loss;
+                bool acked = chance(random) >= loss;
+                if (arrived && acked && now + RoundTripMs < ackAt) {
+                    ackAt = now + RoundTripMs;
+                }
+            }
+        }
+        if (delivery.LastResult() == CriticalDelivery::Result::Failed) {
+            failed++;
+            continue;
+        }
+        ackSum += delivery.AckTime();
+        ackMax = delivery.AckTime() > ackMax ? delivery.AckTime() : ackMax;
+        retrySum += delivery.Retries();
+    }
+    int acked = Stops - failed;
+
+    printf("critical: loss %.2f burst %d  ack mean %.1f ms  max %u ms  retries %.2f  failed %d of %d\n",
+           loss, burst, acked > 0 ? static_cast<double>(ackSum) / acked : 0.0, ackMax,
+           acked > 0 ? static_cast<double>(retrySum) / acked : 0.0, failed, Stops);
+}
+
+void RunCriticalBench()
+{
+    for (double loss : Losses) {
+        for (int burst : Bursts) {
+            RunCritical(loss, burst);
+        }
+    }
+}
@@ -0,0 +1,90 @@
+#include "bench.h"
+
+#include <functional>
+#include <vector>
+
+#include "commanddispatch.h"
+
+static const int Ticks = 200000;
+static const int ButtonCount = 21;
+
+// Команды раскиданы по кнопкам и осям, как в большой раскладке
+static std::vector<CommandDescriptor> MakeCommands(int count)
+{
+    std::vector<CommandDescriptor> commands;
+    for (int i = 0; i < count; i++) {
+        CommandDescriptor command;
+        command.action = CommandAction::SetGear;
+        command.trigger = i % 7 == 6 ? CommandTrigger::Axis : CommandTrigger::Button;
+        command.binding = command.trigger == CommandTrigger::Axis ? i % 6 : i % ButtonCount;
+        command.sample = AxisSample::Last;
+        command.slot = 0;
+        command.value = static_cast<float>(i);
+        command.gain = 1;
+        commands.push_back(command);
+    }
+    return commands;
+}
+
+// Прежняя схема: каждый такт опрос всех команд через std::function
+static double PollingTick(const std::vector<std::function<void()>>& handlers)
+{
+    BenchTimer timer;
+    for (int t = 0; t < Ticks; t++) {
+        for (const auto& handler : handlers) {
+            handler();
+        }
+    }
+    return timer.Seconds() * 1e9 / Ticks;
+}
+
+static double DispatchTick(const CommandDispatcher& dispatcher, const DispatchMask& mask,
+                           const std::function<void(const CommandDescriptor&, bool)>& execute)
+{
+    BenchTimer timer;
+    for (int t = 0; t < Ticks; t++) {
+        dispatcher.Dispatch(mask, execute);
+    }
+    return timer.Seconds() * 1e9 / Ticks;
+}
+
+void RunDispatchBench()
+{
+    const int sizes[] = {6, 50, 200};
+    for (int size : sizes) {
+        std::vector<CommandDescriptor> commands = MakeCommands(size);
+
+        bool current[DispatchTriggerCount] = {};
+        bool previous[DispatchTriggerCount] = {};
+        std::vector<std::function<void()>> handlers;
+        for (const auto& command : commands) {
+            int trigger = DispatchTriggerIndex(command.trigger, command.binding);
+            float value = command.value;
+            handlers.push_back([&current, &previous, trigger, value]() {
+                if (current[trigger] && !previous[trigger]) {
+                    benchSink = benchSink + value;
+                }
+            });
+        }
+
+        CommandDispatcher dispatcher;
+        dispatcher.Build(commands);
+        std::function<void(const CommandDescriptor&, bool)> execute =
+            [](const CommandDescriptor& command, bool pressed) {
+                if (pressed) {
+                    benchSink = benchSink + command.value;
+                }
+            };
+
+        DispatchMask idle;
+        DispatchMask press;
+        press.pressed = 1u << 3;
+
+        double polling = PollingTick(handlers);
+        double idleCost = DispatchTick(dispatcher, idle, execute);
+        double pressCost = DispatchTick(dispatcher, press, execute);
+
+        printf("dispatch %3d commands: polling %.1f ns/tick, indexed idle %.1f ns/tick, indexed press %.1f ns/tick\n",
+               size, polling, idleCost, pressCost);
+    }
+}
@@ -0,0 +1,126 @@
+#include "bench.h"
+
+#include <cmath>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "SDL2/SDL.h"
+#undef main
+
+#include "expression.h"
+
+static const size_t SampleCount = 4096;
+static const int Repeats = 500;
+
+typedef std::function<float(const float* input, const float* scale, unsigned buttons)> HandFormula;
+
+struct FormulaCase
+{
+    const char* text;
+    HandFormula hand;
+};
+
+static float Input(const float* input, SDL_GameControllerAxis axis)
+{
+    return input[MappingSourceIndex(axis, AxisSample::Last)];
+}
+
+void RunExpressionBench()
+{
+    // Формулы и те же правила, написанные вручную, как раньше в коде драйвера
+    const FormulaCase cases[] = {
+        {"lefttrigger > 0.5 ? 0 : rightx * 5 * gear",
+         [](const float* input, const float* scale, unsigned) {
+             return Input(input, SDL_CONTROLLER_AXIS_TRIGGERLEFT) > 0.5f
+                 ? 0.0f : Input(input, SDL_CONTROLLER_AXIS_RIGHTX) * 5 * scale[geo::Yaw];
+         }},
+        {"(righttrigger - lefttrigger) * 3 * gear",
+         [](const float* input, const float* scale, unsigned) {
+             return (Input(input, SDL_CONTROLLER_AXIS_TRIGGERRIGHT) - Input(input, SDL_CONTROLLER_AXIS_TRIGGERLEFT))
+                 * 3 * scale[geo::Yaw];
+         }},
+        {"clamp(expo(lefty, 0.3) * -5 * gear, -4, 4) * !leftshoulder",
+         [](const float* input, const float* scale, unsigned buttons) {
+             float x = Input(input, SDL_CONTROLLER_AXIS_LEFTY);
+             float y = (x * 0.7f + 0.3f * x * x * x) * -5 * scale[geo::Yaw];
+             y = y < -4 ? -4 : (y > 4 ? 4 : y);
+             return (buttons >> SDL_CONTROLLER_BUTTON_LEFTSHOULDER) & 1u ? 0.0f : y;
+         }},
+    };
+
+    std::vector<float> samples(SampleCount * MappingInputCount);
+    std::vector<unsigned> buttons(SampleCount);
+    for (size_t i = 0; i < samples.size(); i++) {
+        samples[i] = static_cast<float>(std::sin(0.007 * i));
+    }
+    for (size_t i = 0; i < SampleCount; i++) {
+        buttons[i] = (i / 64) % 2 ? 1u << SDL_CONTROLLER_BUTTON_LEFTSHOULDER : 0u;
+    }
+    float scale[MappingWidth];
+    for (auto& s : scale) {
+        s = 2;
+    }
+
+    for (const auto& test : cases) {
+        Expression expression;
+        std::string error;
+        if (!CompileExpression(test.text, expression, error)) {
+            printf("expression \"%s\": compile failed: %s\n", test.text, error.c_str());
+            continue;
+        }
+
+        float maxError = 0;
+        for (size_t i = 0; i < SampleCount; i++) {
+            ExpressionInputs inputs = {&samples[i * MappingInputCount], scale, buttons[i]};
+            float compiled = EvaluateExpression(expression, inputs, geo::Yaw);
+            float hand = test.hand(inputs.input, scale, buttons[i]);
+            maxError = std::fmax(maxError, std::fabs(compiled - hand));
+        }
+
+        BenchTimer handTimer;
+        for (int r = 0; r < Repeats; r++) {
+            for (size_t i = 0; i < SampleCount; i++) {
+                benchSink = benchSink + test.hand(&samples[i * MappingInputCount], scale, buttons[i]);
+            }
+        }
+        double handTime = handTimer.Seconds() * 1e9 / (SampleCount * Repeats);
+
+        BenchTimer compiledTimer;
+        for (int r = 0; r < Repeats; r++) {
+            for (size_t i = 0; i < SampleCount; i++) {
+                ExpressionInputs inputs = {&samples[i * MappingInputCount], scale, buttons[i]};
+                benchSink = benchSink + EvaluateExpression(expression, inputs, geo::Yaw);
+            }
+        }
+        double compiledTime = compiledTimer.Seconds() * 1e9 / (SampleCount * Repeats);
+
+        printf("expression \"%s\": %d ops, cost %d, %d registers; lambda %.2f ns, bytecode %.2f ns, max diff %g\n",
+               test.text, expression.length, ExpressionCost(expression), expression.registers,
+               handTime, compiledTime, maxError);
+    }
+
+    // Проверка отвергает формулы, которые не укладываются в пределы
+    const char* const rejected[] = {
+        "rightx * 5 * unknown",
+        "loop(rightx)",
+        "rightx * (2",
+        "leftx + (lefty + (rightx + (righty + (leftx + (lefty + (rightx + (righty + 1)))))))",
+        "rightx / 2 / 2 / 2 / 2 / 2 / 2 / 2 / 2 / 2 / 2 / 2 / 2 / 2 / 2 / 2 / 2",
+    };
+    for (const char* text : rejected) {
+        Expression expression;
+        std::string error;
+        bool accepted = CompileExpression(text, expression, error);
+        printf("validator: \"%s\" -> %s\n", text, accepted ? "accepted" : error.c_str());
+    }
+
+    // Подделанная программа с чтением незаписанного регистра
+    Expression forged;
+    forged.length = 1;
+    forged.constantCount = 0;
+    forged.registers = 2;
+    forged.code[0] = {ExpressionOp::Add, 0, 0, 1, 0};
+    std::string error;
+    printf("validator: forged bytecode -> %s\n", ValidateExpression(forged, error) ? "accepted" : error.c_str());
+}
@@ -0,0 +1,80 @@
+#include "bench.h"
+
+#include <cmath>
+#include <vector>
+
+#include "fixedmapping.h"
+
+static const size_t SampleCount = 4096;
+static const int Repeats = 500;
+static const float Deadzone = 0.2f;
+
+static void BuildTable(MappingTable& table)
+{
+    ClearMapping(table);
+    BindMappingAxis(table, geo::Forward, MappingSourceIndex(1, AxisSample::Last), -5, 0,
+                    motion::ControlType::Velocity, scene::Absent);
+    BindMappingAxis(table, geo::Yaw, MappingSourceIndex(2, AxisSample::Mean), 5, 0.3f,
+                    motion::ControlType::Velocity, scene::Absent);
+    BindMappingConstant(table, geo::Up, 25, motion::ControlType::Force, scene::Absent);
+    BindMappingConstant(table, geo::Pitch, 7.5, motion::ControlType::Force, scene::Absent);
+    table.limit[geo::Yaw] = 6;
+}
+
+void RunFixedBench()
+{
+    MappingTable table;
+    BuildTable(table);
+    FixedMappingTable fixedTable;
+    CompileFixedMapping(table, fixedTable);
+
+    // Одни и те же сырые отсчеты для обоих путей, как их отдает Gamepad
+    const int16_t deadzone = DeadzoneToQ15(Deadzone);
+    std::vector<int16_t> raw(SampleCount * MappingInputCount);
+    std::vector<float> normalized(raw.size());
+    for (size_t i = 0; i < raw.size(); i++) {
+        int value = static_cast<int>(32768 * std::sin(0.003 * i));
+        raw[i] = ApplyDeadzoneQ15(NormalizeQ15(value), deadzone);
+        normalized[i] = static_cast<float>(static_cast<double>(raw[i]) / Q15One);
+    }
+
+    float scale[MappingWidth];
+    int32_t fixedScale[MappingWidth];
+    for (int i = 0; i < MappingWidth; i++) {
+        scale[i] = 0.5f;
+        fixedScale[i] = ToQ16(scale[i]);
+    }
+
+    std::vector<float> floatValues(SampleCount * MappingWidth);
+    std::vector<int32_t> fixedValues(SampleCount * MappingWidth);
+    std::vector<unsigned> floatMasks(SampleCount);
+    std::vector<unsigned> fixedMasks(SampleCount);
+
+    BenchTimer floatTimer;
+    for (int r = 0; r < Repeats; r++) {
+        MapSamplesScalar(table, scale, normalized.data(), SampleCount, floatValues.data(), floatMasks.data());
+        benchSink = benchSink + floatValues[r];
+    }
+    double floatRate = SampleCount * Repeats / floatTimer.Seconds();
+
+    BenchTimer fixedTimer;
+    for (int r = 0; r < Repeats; r++) {
+        MapSamplesFixed(fixedTable, fixedScale, raw.data(), SampleCount, fixedValues.data(), fixedMasks.data());
+        benchSink = benchSink + fixedValues[r];
+    }
+    double fixedRate = SampleCount * Repeats / fixedTimer.Seconds();
+
+    // Сверка с плавающей точкой: ошибка квантования Q15/Q16.16 и совпадение масок
+    double maxError = 0;
+    size_t maskMismatch = 0;
+    for (size_t i = 0; i < floatValues.size(); i++) {
+        double value = static_cast<double>(fixedValues[i]) / Q16One;
+        maxError = std::fmax(maxError, std::fabs(value - floatValues[i]));
+    }
+    for (size_t i = 0; i < SampleCount; i++) {
+        maskMismatch += floatMasks[i] != fixedMasks[i];
+    }
+
+    printf("fixed point: float %.3g samples/s, Q15 %.3g samples/s (x%.2f), max diff %g, mask mismatch %zu\n",
+           floatRate, fixedRate, fixedRate / floatRate, maxError, maskMismatch);
+}
@@ -0,0 +1,128 @@
+#include "bench.h"
+
+#include <cmath>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include "controlframe.h"
+#include "latencyhistogram.h"
+#include "monotonic.h"
+
+static const int Frames = 5000000;
+static const int Datagrams = 20000;
+
+#ifdef _WIN32
+typedef SOCKET Socket;
+static void CloseSocket(Socket s) { closesocket(s); }
+#else
+typedef int Socket;
+static const Socket INVALID_SOCKET = -1;
+static void CloseSocket(Socket s) { close(s); }
+#endif
+
+// Настоящие датаграммы через 127.0.0.1: задержка UDP-пути от кодирования
+// до разбора на приеме, без сети. Шину так не замерить, ее задержку по
+// каждому пути показывает стенд (src/standin).
+static void RunFrameLoopback(const motion::Control& control)
+{
+#ifdef _WIN32
+    WSADATA wsa;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0) {
+        printf("frame: loopback skipped, no sockets\n");
+        return;
+    }
+#endif
+    Socket receiver = socket(AF_INET, SOCK_DGRAM, 0);
+    Socket sender = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;
+    socklen_t length = sizeof(address);
+    if (receiver == INVALID_SOCKET || sender == INVALID_SOCKET
+            || bind(receiver, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0
+            || getsockname(receiver, reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+        printf("frame: loopback skipped, no sockets\n");
+    }
+    else {
+        uint8_t frame[ControlFrameSize];
+        uint8_t buffer[ControlFrameSize + 16];
+        motion::Control decoded;
+        ControlFrameHeader header;
+        ControlFrameHeader received;
+        LatencyHistogram histogram;
+        int lost = 0;
+        for (int i = 0; i < Datagrams; i++) {
+            header.sequence = static_cast<uint32_t>(i);
+            header.timestamp = MonotonicMicroseconds();
+            EncodeControlFrame(control, header, frame);
+            sendto(sender, reinterpret_cast<const char*>(frame), sizeof(frame), 0,
+                   reinterpret_cast<const sockaddr*>(&address), sizeof(address));
+            int bytes = recv(receiver, reinterpret_cast<char*>(buffer), sizeof(buffer), 0);
+            if (bytes <= 0 || !DecodeControlFrame(buffer, bytes, decoded, received)
+                    || received.sequence != header.sequence) {
+                lost++;
+                continue;
+            }
+            histogram.Record(MonotonicMicroseconds() - received.timestamp);
+        }
+        printf("frame: udp loopback %d datagrams, mean %.1f us, p50 %llu us, p99 %llu us, max %llu us, %d lost\n",
+               Datagrams, histogram.Mean(), static_cast<unsigned long long>(histogram.Percentile(0.5)),
+               static_cast<unsigned long long>(histogram.Percentile(0.99)),
+               static_cast<unsigned long long>(histogram.Max()), lost);
+    }
+    if (receiver != INVALID_SOCKET) {
+        CloseSocket(receiver);
+    }
+    if (sender != INVALID_SOCKET) {
+        CloseSocket(sender);
+    }
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
+
+void RunFrameBench()
+{
+    motion::Control control;
+    control.time_limit = 2;
+    control.priority = motion::Priority::Highest;
+    control.is_compensation = false;
+    for (int i = 0; i < geo::Num; i++) {
+        control.parameters[i].type = motion::ControlType::Force;
+        control.parameters[i].frame = scene::Absent;
+    }
+
+    uint8_t frame[ControlFrameSize];
+    motion::Control decoded;
+    ControlFrameHeader header;
+    ControlFrameHeader received;
+    int rejected = 0;
+
+    BenchTimer timer;
+    for (int i = 0; i < Frames; i++) {
+        control.parameters[geo::Forward].value = std::sin(i * 0.001);
+        header.sequence = static_cast<uint32_t>(i);
+        header.timestamp = static_cast<uint64_t>(i) * 1000;
+        EncodeControlFrame(control, header, frame);
+        if (!DecodeControlFrame(frame, sizeof(frame), decoded, received) || received.sequence != header.sequence) {
+            rejected++;
+        }
+        benchSink = benchSink + static_cast<float>(decoded.parameters[geo::Forward].value);
+    }
+    double seconds = timer.Seconds();
+
+    printf("frame: %.1f ns/encode+decode, %d bytes vs motion::Control %d bytes, %d rejected\n",
+           seconds * 1e9 / Frames, static_cast<int>(ControlFrameSize), static_cast<int>(sizeof(motion::Control)),
+           rejected);
+
+    RunFrameLoopback(control);
+}
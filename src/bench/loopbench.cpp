@@ -0,0 +1,72 @@
+#include "bench.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "looplatency.h"
+
+static const int Changes = 200000;
+static const uint64_t PeriodUs = 100000;          // Команда меняется раз в такт отправки
+static const int Records = 10000000;
+
+// Отклик сил через логнормальную задержку ~3 мс; сверяем перцентили гистограммы с точными
+static void RunLoopCorrelation()
+{
+    std::minstd_rand random(5);
+    std::lognormal_distribution<double> delay(8.0, 0.5);
+
+    LoopLatency loop;
+    loop.Configure(LoopLatencySettings());
+    motion::Control control;
+    motion::Forces forces;
+    for (int i = 0; i < geo::Num; i++) {
+        control.parameters[i].type = motion::ControlType::Force;
+        control.parameters[i].frame = scene::Absent;
+        control.parameters[i].value = 0;
+        forces.limit[i] = 0;
+        forces.unlimit[i] = 0;
+    }
+    loop.ForcesReceived(forces, 0);
+
+    std::vector<uint64_t> truth;
+    truth.reserve(Changes);
+    for (int i = 0; i < Changes; i++) {
+        uint64_t sent = (i + 1) * PeriodUs;
+        double value = (i % 2 == 0) ? 0.5 : -0.5;
+        control.parameters[geo::Forward].value = value;
+        loop.ControlSent(control, sent);
+        uint64_t latency = static_cast<uint64_t>(delay(random));
+        forces.limit[geo::Forward] = value * 100;
+        loop.ForcesReceived(forces, sent + latency);
+        truth.push_back(latency);
+    }
+    std::sort(truth.begin(), truth.end());
+
+    const LatencyHistogram& histogram = loop.Histogram();
+    printf("loop: %u samples, %u timeouts; p50 %llu/%llu us, p99 %llu/%llu us (histogram/exact)\n",
+           histogram.Count(), loop.Timeouts(),
+           static_cast<unsigned long long>(histogram.Percentile(0.5)),
+           static_cast<unsigned long long>(truth[truth.size() / 2 - 1]),
+           static_cast<unsigned long long>(histogram.Percentile(0.99)),
+           static_cast<unsigned long long>(truth[truth.size() * 99 / 100 - 1]));
+}
+
+static void RunHistogramRecord()
+{
+    LatencyHistogram histogram;
+    BenchTimer timer;
+    for (int i = 0; i < Records; i++) {
+        histogram.Record(static_cast<uint64_t>(i) * 2654435761u % 5000000);
+    }
+    double seconds = timer.Seconds();
+    benchSink = benchSink + static_cast<float>(histogram.Percentile(0.99));
+    printf("loop: histogram %.1f ns/record, %d buckets, %d bytes\n",
+           seconds * 1e9 / Records, LatencyHistogram::BucketCount, static_cast<int>(sizeof(LatencyHistogram)));
+}
+
+void RunLoopBench()
+{
+    RunLoopCorrelation();
+    RunHistogramRecord();
+}
@@ -0,0 +1,20 @@
+#include "bench.h"
+
+volatile float benchSink = 0;
+
+int main()
+{
+    RunMappingBench();
+    RunFixedBench();
+    RunPredictorBench();
+    RunDispatchBench();
+    RunStaticBench();
+    RunExpressionBench();
+    RunBundleBench();
+    RunFrameBench();
+    RunRedundantBench();
+    RunCriticalBench();
+    RunLoopBench();
+    RunAdaptBench();
+    return 0;
+}
@@ -0,0 +1,82 @@
+#include "bench.h"
+
+#include <cmath>
+#include <vector>
+
+#include "mapping.h"
+
+static const size_t SampleCount = 4096;
+static const int Repeats = 500;
+
+// Таблица, как в драйвере по умолчанию: вперед и курс по скорости, вверх и дифферент постоянные
+static void BuildDefaultTable(MappingTable& table)
+{
+    ClearMapping(table);
+    BindMappingAxis(table, geo::Forward, MappingSourceIndex(1, AxisSample::Last), -5, 0,
+                    motion::ControlType::Velocity, scene::Absent);
+    BindMappingAxis(table, geo::Yaw, MappingSourceIndex(2, AxisSample::Mean), 5, 0.3f,
+                    motion::ControlType::Velocity, scene::Absent);
+    BindMappingAxis(table, geo::Right, MappingSourceIndex(0, AxisSample::Peak), 3, 0.5f,
+                    motion::ControlType::Force, scene::Absent);
+    BindMappingConstant(table, geo::Up, 25, motion::ControlType::Force, scene::Absent);
+    BindMappingConstant(table, geo::Pitch, 7.5, motion::ControlType::Force, scene::Absent);
+    table.limit[geo::Yaw] = 6;
+}
+
+// Записанные отсчеты: синусоиды с выпадением в мертвую зону
+static void FillSamples(std::vector<float>& samples)
+{
+    for (size_t i = 0; i < SampleCount; i++) {
+        for (int j = 0; j < MappingInputCount; j++) {
+            float v = static_cast<float>(std::sin(0.01 * i * (j + 1)));
+            samples[i * MappingInputCount + j] = std::fabs(v) < 0.2f ? 0.0f : v;
+        }
+    }
+}
+
+typedef void (*BatchKernel)(const MappingTable&, const float*, const float*, size_t, float*, unsigned*);
+
+static double Measure(BatchKernel kernel, const MappingTable& table, const float* scale,
+                      const std::vector<float>& samples, std::vector<float>& values, std::vector<unsigned>& masks)
+{
+    BenchTimer timer;
+    for (int r = 0; r < Repeats; r++) {
+        kernel(table, scale, samples.data(), SampleCount, values.data(), masks.data());
+        benchSink = benchSink + values[r % values.size()];
+    }
+    return SampleCount * Repeats / timer.Seconds();
+}
+
+void RunMappingBench()
+{
+    MappingTable table;
+    BuildDefaultTable(table);
+
+    float scale[MappingWidth];
+    for (auto& s : scale) {
+        s = 0.5f;
+    }
+
+    std::vector<float> samples(SampleCount * MappingInputCount);
+    FillSamples(samples);
+
+    std::vector<float> scalarValues(SampleCount * MappingWidth);
+    std::vector<float> simdValues(SampleCount * MappingWidth);
+    std::vector<unsigned> scalarMasks(SampleCount);
+    std::vector<unsigned> simdMasks(SampleCount);
+
+    double scalarRate = Measure(MapSamplesScalar, table, scale, samples, scalarValues, scalarMasks);
+    double simdRate = Measure(MapSamples, table, scale, samples, simdValues, simdMasks);
+
+    float maxError = 0;
+    size_t maskMismatch = 0;
+    for (size_t i = 0; i < scalarValues.size(); i++) {
+        maxError = std::fmax(maxError, std::fabs(scalarValues[i] - simdValues[i]));
+    }
+    for (size_t i = 0; i < SampleCount; i++) {
+        maskMismatch += scalarMasks[i] != simdMasks[i];
+    }
+
+    printf("mapping: scalar %.3g samples/s, %s %.3g samples/s (x%.2f), max diff %g, mask mismatch %zu\n",
+           scalarRate, MappingKernelName(), simdRate, simdRate / scalarRate, maxError, maskMismatch);
+}
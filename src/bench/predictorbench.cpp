@@ -0,0 +1,36 @@
+#include "bench.h"
+
+#include <cmath>
+#include <vector>
+
+#include "predictor.h"
+
+static const int Updates = 2000000;
+static const uint32_t TickMs = 10;
+static const int PeriodTicks = 200;
+static const double Pi = 3.14159265358979;
+
+void RunPredictorBench()
+{
+    PredictorSettings settings;
+    settings.enabled = true;
+    settings.latency = 0.1;
+
+    AxisPredictor predictor;
+    predictor.Configure(settings);
+
+    // Маневр: синус 0.5 Гц на полный ход ручки
+    std::vector<int32_t> signal(PeriodTicks);
+    for (int i = 0; i < PeriodTicks; i++) {
+        signal[i] = static_cast<int32_t>(32767 * std::sin(2 * Pi * i / PeriodTicks));
+    }
+
+    BenchTimer timer;
+    for (int i = 0; i < Updates; i++) {
+        benchSink = benchSink + predictor.Update(signal[i % PeriodTicks], i * TickMs);
+    }
+    double seconds = timer.Seconds();
+
+    printf("predictor: %.1f ns/update, rms error %.4f vs hold %.4f at %.0f ms latency\n",
+           seconds * 1e9 / Updates, predictor.PredictionError(), predictor.HoldError(), settings.latency * 1000);
+}
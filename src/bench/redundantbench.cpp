@@ -0,0 +1,93 @@
+#include "bench.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "controldedup.h"
+
+static const int Commands = 200000;
+static const uint64_t PeriodUs = 10000;          // Команда каждые 10 мс
+static const double Losses[] = {0.01, 0.05, 0.2};
+
+// Задержки путей на петле: шина - с очередью, UDP - почти без; хвосты экспоненциальные
+static const double BusBaseUs = 300, BusJitterUs = 200;
+static const double UdpBaseUs = 15, UdpJitterUs = 20;
+
+// Тяжелый случай: UDP теряет, шина отстает больше периода команд, так что копия
+// по шине приходит после следующей команды по UDP
+static const double SlowBusBaseUs = 25000;
+static const double SlowBusUdpLoss = 0.2;
+
+struct Arrival
+{
+    uint64_t time;
+    uint32_t sequence;
+    uint64_t timestamp;
+    ControlDedup::Path path;
+
+    bool operator<(const Arrival& other) const { return time < other.time; }
+};
+
+static void RunRedundant(double busLoss, double udpLoss, double busBaseUs)
+{
+    std::minstd_rand random(7);
+    std::uniform_real_distribution<double> chance(0.0, 1.0);
+    std::exponential_distribution<double> busJitter(1.0 / BusJitterUs);
+    std::exponential_distribution<double> udpJitter(1.0 / UdpJitterUs);
+
+    // Потери путей независимы, одинаковой доли
+    std::vector<Arrival> arrivals;
+    arrivals.reserve(2 * Commands);
+    double busSum = 0, udpSum = 0;
+    int busCount = 0, udpCount = 0;
+    for (int i = 0; i < Commands; i++) {
+        uint64_t sent = i * PeriodUs;
+        uint32_t sequence = static_cast<uint32_t>(i + 1);
+        if (chance(random) >= busLoss) {
+            uint64_t delay = static_cast<uint64_t>(busBaseUs + busJitter(random));
+            arrivals.push_back({sent + delay, sequence, sent, ControlDedup::Bus});
+            busSum += delay;
+            busCount++;
+        }
+        if (chance(random) >= udpLoss) {
+            uint64_t delay = static_cast<uint64_t>(UdpBaseUs + udpJitter(random));
+            arrivals.push_back({sent + delay, sequence, sent, ControlDedup::Udp});
+            udpSum += delay;
+            udpCount++;
+        }
+    }
+    std::sort(arrivals.begin(), arrivals.end());
+
+    // Потребитель не должен получить команду старше уже полученной
+    ControlDedup dedup;
+    double deliveredSum = 0;
+    int delivered = 0;
+    int stale = 0;
+    uint32_t newest = 0;
+    BenchTimer timer;
+    for (const Arrival& arrival : arrivals) {
+        if (dedup.Accept(arrival.path, arrival.sequence, arrival.timestamp)) {
+            deliveredSum += static_cast<double>(arrival.time - arrival.timestamp);
+            delivered++;
+            stale += arrival.sequence < newest ? 1 : 0;
+            newest = std::max(newest, arrival.sequence);
+        }
+    }
+    double seconds = timer.Seconds();
+
+    printf("redundant: loss bus %.2f udp %.2f -> %.5f merged (both lost %.5f); latency mean bus %.1f us, "
+           "udp %.1f us, merged %.1f us; first bus %u udp %u, late %u, stale applied %d; %.1f ns/copy\n",
+           busLoss, udpLoss, 1.0 - static_cast<double>(delivered) / Commands, busLoss * udpLoss,
+           busSum / busCount, udpSum / udpCount, deliveredSum / delivered,
+           dedup.Wins(ControlDedup::Bus), dedup.Wins(ControlDedup::Udp), dedup.Late(), stale,
+           seconds * 1e9 / arrivals.size());
+}
+
+void RunRedundantBench()
+{
+    for (double loss : Losses) {
+        RunRedundant(loss, loss, BusBaseUs);
+    }
+    RunRedundant(0.0, SlowBusUdpLoss, SlowBusBaseUs);
+}
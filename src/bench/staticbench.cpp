@@ -0,0 +1,122 @@
+#include "bench.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <vector>
+
+#include "flightbindings.h"
+
+static const size_t SampleCount = 4096;
+static const int Repeats = 500;
+static const int DispatchTicks = 200000;
+
+void RunStaticBench()
+{
+    CommandTable table;
+    FlightBindings::Descriptors(table);
+    MappingTable mapping;
+    table.BuildMapping(mapping);
+
+    // Типы и системы координат слотов должны совпасть с таблицей из набора привязок
+    MappingTable compiledMapping;
+    FlightBindings::BuildMapping(compiledMapping);
+    int slotMismatch = 0;
+    for (int i = 0; i < geo::Num; i++) {
+        slotMismatch += mapping.activeType[i] != compiledMapping.activeType[i]
+                     || mapping.activeFrame[i] != compiledMapping.activeFrame[i];
+    }
+
+    std::vector<float> samples(SampleCount * MappingInputCount);
+    for (size_t i = 0; i < samples.size(); i++) {
+        float v = static_cast<float>(std::sin(0.007 * i));
+        samples[i] = std::fabs(v) < 0.2f ? 0.0f : v;
+    }
+    float scale[MappingWidth];
+    for (auto& s : scale) {
+        s = 2;
+    }
+
+    // Сверка отображения
+    float maxError = 0;
+    size_t maskMismatch = 0;
+    for (size_t i = 0; i < SampleCount; i++) {
+        MappedControl runtime;
+        MappedControl compiled;
+        MapControlScalar(mapping, &samples[i * MappingInputCount], scale, runtime);
+        FlightBindings::Map(&samples[i * MappingInputCount], scale, compiled);
+        for (int j = 0; j < geo::Num; j++) {
+            maxError = std::fmax(maxError, std::fabs(runtime.value[j] - compiled.value[j]));
+        }
+        maskMismatch += runtime.activeMask != compiled.activeMask;
+    }
+
+    BenchTimer runtimeTimer;
+    for (int r = 0; r < Repeats; r++) {
+        MappedControl mapped;
+        for (size_t i = 0; i < SampleCount; i++) {
+            MapControl(mapping, &samples[i * MappingInputCount], scale, mapped);
+            benchSink = benchSink + mapped.value[geo::Forward];
+        }
+    }
+    double runtimeRate = SampleCount * Repeats / runtimeTimer.Seconds();
+
+    BenchTimer compiledTimer;
+    for (int r = 0; r < Repeats; r++) {
+        MappedControl mapped;
+        for (size_t i = 0; i < SampleCount; i++) {
+            FlightBindings::Map(&samples[i * MappingInputCount], scale, mapped);
+            benchSink = benchSink + mapped.value[geo::Forward];
+        }
+    }
+    double compiledRate = SampleCount * Repeats / compiledTimer.Seconds();
+
+    printf("static bindings: runtime map %.3g samples/s, compiled map %.3g samples/s, max diff %g, "
+           "mask mismatch %zu, slot mismatch %d\n",
+           runtimeRate, compiledRate, maxError, maskMismatch, slotMismatch);
+
+    // Сверка диспетчеризации: для каждой кнопки тот же набор команд (порядок внутри тика не важен)
+    CommandDispatcher dispatcher;
+    dispatcher.Build(table.Descriptors());
+    size_t dispatchMismatch = 0;
+    for (int button = 0; button < DispatchButtonSlots; button++) {
+        DispatchMask mask;
+        mask.pressed = 1u << button;
+        mask.released = 1u << ((button + 1) % DispatchButtonSlots);
+
+        std::vector<float> runtimeCalls;
+        std::vector<float> compiledCalls;
+        dispatcher.Dispatch(mask, [&runtimeCalls](const CommandDescriptor& c, bool pressed) {
+            runtimeCalls.push_back(c.action * 100 + c.value + (pressed ? 1000 : 0));
+        });
+        FlightBindings::Dispatch(mask, [&compiledCalls](const CommandDescriptor& c, bool pressed) {
+            compiledCalls.push_back(c.action * 100 + c.value + (pressed ? 1000 : 0));
+        });
+        std::sort(runtimeCalls.begin(), runtimeCalls.end());
+        std::sort(compiledCalls.begin(), compiledCalls.end());
+        dispatchMismatch += runtimeCalls != compiledCalls;
+    }
+
+    DispatchMask press;
+    press.pressed = 1u << SDL_CONTROLLER_BUTTON_A;
+    std::function<void(const CommandDescriptor&, bool)> execute = [](const CommandDescriptor& c, bool) {
+        benchSink = benchSink + c.value;
+    };
+
+    BenchTimer runtimeDispatchTimer;
+    for (int t = 0; t < DispatchTicks; t++) {
+        dispatcher.Dispatch(press, execute);
+    }
+    double runtimeDispatch = runtimeDispatchTimer.Seconds() * 1e9 / DispatchTicks;
+
+    BenchTimer compiledDispatchTimer;
+    for (int t = 0; t < DispatchTicks; t++) {
+        FlightBindings::Dispatch(press, [](const CommandDescriptor& c, bool) {
+            benchSink = benchSink + c.value;
+        });
+    }
+    double compiledDispatch = compiledDispatchTimer.Seconds() * 1e9 / DispatchTicks;
+
+    printf("static bindings: runtime dispatch %.1f ns/tick, compiled dispatch %.1f ns/tick, mismatched buttons %zu\n",
+           runtimeDispatch, compiledDispatch, dispatchMismatch);
+}
@@ -1,6 +1,9 @@
 #include "application.h"
+#include "monotonic.h"
 #include "motion.h"
-#include "commands.h"
+
+#include <algorithm>
+#include <cstdio>
 
 
 Application::Application()
@@ -13,16 +16,44 @@ Application::Application()
 
 Application::~Application()
 {
+    delete[] macros;
+    delete configReloader;
+    delete config;
+    delete reloadReceiver;
+    delete pilotReceiver;
+    delete linkReceiver;
+    delete ackReceiver;
+    delete workReceiver;
+    delete forcesReceiver;
     delete core;
     delete controlSender;
     delete gamepad;
     delete gamepadStateSender;
+    delete gamepadTelemetrySender;
+    delete gamepadLayoutSender;
+    delete bundleSender;
+    delete controlStampSender;
+    delete udpSender;
     delete programStateSender;
 
+    macros = nullptr;
+    configReloader = nullptr;
+    config = nullptr;
+    reloadReceiver = nullptr;
+    pilotReceiver = nullptr;
+    linkReceiver = nullptr;
+    ackReceiver = nullptr;
+    workReceiver = nullptr;
+    forcesReceiver = nullptr;
     core = nullptr;
     controlSender = nullptr;
     gamepad = nullptr;
     gamepadStateSender = nullptr;
+    gamepadTelemetrySender = nullptr;
+    gamepadLayoutSender = nullptr;
+    bundleSender = nullptr;
+    controlStampSender = nullptr;
+    udpSender = nullptr;
     programStateSender = nullptr;
 }
 
@@ -34,47 +65,177 @@ void Application::Initialize(int argc, char *argv[], ipc::Core::Description desc
     programStateSender = new Sender<Message::State>(core);
     programStateSender->Initialize();
 
-    const Message::State& programState = programStateSender->GetData();
-    sendStateInterval = programState.settings.state_timer;
-    sendDataInterval =programState.settings.send_timer;
-
-    LoadGamepadBindings();
-
+    // До настроек: период повтора команды считается от ее time_limit
     controlSender = new Sender<motion::Control>(core);
+    controlSender->Initialize();
     SetDefaultDataForControlCommandSender();
+    nominalTimeLimit = controlSender->GetData().time_limit;
+    controlStampSender = new Sender<Message::ControlStamp>(core);
+    udpSender = new ipc::UdpSocketSender(*core);
+    bundleSender = new Sender<Message::ControlBundle>(core);
+
+    configReloader = new ConfigReloader(*core, [this](const CommandDescriptor& command, bool pressed) {
+        ExecuteCommand(command, pressed);
+    });
+    ApplyConfig(configReloader->LoadInitial());
+    reloadReceiver = new ipc::Receiver<Message::Reload>(*core);
+    pilotReceiver = new ipc::Receiver<Message::Pilot>(*core);
+    linkReceiver = new ipc::Receiver<Message::LinkDiagnostics>(*core);
+    ackReceiver = new ipc::Receiver<Message::ControlAck>(*core);
+    workReceiver = new ipc::Receiver<motion::Work>(*core);
+    forcesReceiver = new ipc::Receiver<motion::Forces>(*core);
 
-    CreateCommands();
+    // Профили разбираются один раз при запуске, при подключении пульта только выбираются
+    ipc::Loader<Message::Profiles> profiles(*core);
+    if (profileStore.Load(core->load_path(), profiles._)) {
+        std::cout << "Profiles loaded: " << profileStore.Count()
+                  << (profileStore.FromCache() ? " (cache)" : "") << std::endl;
+    }
+
+    // Все буферы макросов выделяются здесь, дальше запись и воспроизведение без выделений
+    macros = new ControlMacro[MacroSlots];
+    for (int i = 0; i < MacroSlots; i++) {
+        macros[i].Load(MacroPath(i));
+    }
 }
 
-void Application::LoadGamepadBindings() {
-    const auto& gamepadBindings = programStateSender->GetData().bindings;
-    Commands::start_control.bindingKey = SDL_GameControllerGetButtonFromString(
-        gamepadBindings.button_commands.start_control.binding.to_std_string().c_str()
-    );
-    Commands::stop_control.bindingKey = SDL_GameControllerGetButtonFromString(
-        gamepadBindings.button_commands.stop_control.binding.to_std_string().c_str()
-    );
+// Настройки, при неизменности которых подстройка продолжает с набранного состояния
+static bool SameLinkAdaptation(const Message::Init& a, const Message::Init& b)
+{
+    return a.send_timer == b.send_timer && a.send_timer_min == b.send_timer_min
+        && a.send_timer_max == b.send_timer_max && a.time_limit_min == b.time_limit_min
+        && a.time_limit_max == b.time_limit_max && a.queue_target == b.queue_target
+        && a.adapt_link == b.adapt_link;
+}
+
+void Application::ApplyConfig(DriverConfig* next)
+{
+    DriverConfig* previous = config;
+    config = next;
+
+    sendStateInterval = config->settings.state_timer;
+    sendDataInterval = config->settings.send_timer;
+    gamepad->ConfigureDeadzone(config->deadzone);
+    gamepad->ConfigurePredictor(config->predictor);
+
+    // Подстройка начинает с настроенного периода и исходного time_limit; без нее
+    // возвращается исходный time_limit. Выбор профиля и перезагрузка, не менявшие
+    // настроек подстройки, оставляют набранное состояние канала.
+    const Message::Init& settings = config->settings;
+    if (settings.adapt_link && previous != nullptr && SameLinkAdaptation(previous->settings, settings)) {
+        sendDataInterval = linkAdapter.Interval();
+        controlSender->GetData().time_limit = linkAdapter.TimeLimit();
+    }
+    else if (settings.adapt_link) {
+        LinkAdapterSettings adapt;
+        adapt.intervalMin = settings.send_timer_min;
+        adapt.intervalMax = std::max(settings.send_timer_min, settings.send_timer_max);
+        adapt.timeLimitMin = settings.time_limit_min;
+        adapt.timeLimitMax = std::max(settings.time_limit_min, settings.time_limit_max);
+        adapt.queueTarget = settings.queue_target;
+        linkAdapter.Configure(adapt, sendDataInterval, nominalTimeLimit);
+        linkBaseline = false;
+        sendDataInterval = linkAdapter.Interval();
+        controlSender->GetData().time_limit = linkAdapter.TimeLimit();
+    }
+    else {
+        controlSender->GetData().time_limit = nominalTimeLimit;
+    }
+    ConfigureControlPolicy();
+    udpHost = config->settings.udp_host.to_std_string();
 
-    Commands::set_min_speed.bindingKey = SDL_GameControllerGetButtonFromString(
-        gamepadBindings.button_commands.set_min_speed.binding.to_std_string().c_str()
-    );
-    Commands::set_slow_speed.bindingKey = SDL_GameControllerGetButtonFromString(
-        gamepadBindings.button_commands.set_slow_speed.binding.to_std_string().c_str()
-    );
-    Commands::set_max_speed.bindingKey = SDL_GameControllerGetButtonFromString(
-        gamepadBindings.button_commands.set_max_speed.binding.to_std_string().c_str()
-    );
-    Commands::set_zero_speed.bindingKey = SDL_GameControllerGetButtonFromString(
-        gamepadBindings.button_commands.set_zero_speed.binding.to_std_string().c_str()
-    );
+    CriticalSettings criticalSettings;
+    criticalSettings.burst = config->settings.critical_burst;
+    criticalSettings.retry = static_cast<uint32_t>(config->settings.critical_retry * 1000);
+    criticalSettings.retries = config->settings.critical_retries;
+    critical.Configure(criticalSettings);
+    criticalInterval = config->settings.critical_retry / 2;
 
+    LoopLatencySettings loop;
+    loop.timeout = static_cast<uint64_t>(config->settings.loop_timeout * 1e6);
+    loop.tolerance = config->settings.loop_tolerance;
+    loopLatency.Configure(loop);
 
-    Commands::move_forward.bindingAxis = SDL_GameControllerGetAxisFromString(
-        gamepadBindings.axis_commands.move_forward.binding.to_std_string().c_str()
-    );
-    Commands::move_right.bindingAxis = SDL_GameControllerGetAxisFromString(
-        gamepadBindings.axis_commands.move_right.binding.to_std_string().c_str()
-    );
+    // Недобранный пакет уходит до смены размера, чтобы не смешать отсчеты разных настроек
+    double rate = config->settings.sample_rate;
+    if (bundler.Count() > 0) {
+        FlushBundle(SDL_GetTicks());
+    }
+    bundler.Configure(config->settings.bundle_size);
+    sampleInterval = rate > 0 ? 1.0 / rate : 0;
+
+    // Выбранная передача переживает перезагрузку, если она есть в новой таблице
+    int gear = speedGears.Current();
+    speedGears.Configure(config->gears);
+    if (previous != nullptr) {
+        speedGears.Select(gear);
+    }
+
+    Message::State& programState = programStateSender->GetData();
+    CopyMessage(programState.settings, config->settings);
+    CopyMessage(programState.bindings, config->bindings);
+    programState.profile = config->profile;
+
+    // Слой, которого нет в новой конфигурации, сбрасывается на базовый
+    if (toggledLayer >= config->layerCount) {
+        toggledLayer = 0;
+    }
+    if (shiftedLayer >= config->layerCount) {
+        shiftedLayer = -1;
+    }
+    activeLayer = -1;
+    UpdateLayer();
+
+    if (previous != nullptr) {
+        std::cout << "Config reloaded, version " << config->version << std::endl;
+        core->log("Настройки перечитаны, версия " + std::to_string(config->version));
+    }
+    delete previous;
+}
+
+bool Application::MapControlCommand()
+{
+    motion::Control& controlData = controlSender->GetData();
+    const BindingLayer& layer = config->layers[activeLayer];
+
+    // Формулы считаются в плавающей точке, слой с формулами идет мимо целочисленного ядра
+    if (config->useFixedPoint && layer.formulas.mask == 0) {
+        int16_t input[MappingInputCount];
+        gamepad->GetMappingInputFixed(input);
+
+        FixedMappedControl mapped;
+        MapControlFixed(layer.fixedMapping, input, speedGears.ScaleFixed(), mapped);
+        if (mapped.activeMask == 0) {
+            return false;
+        }
+        ApplyFixedMapping(layer.mapping, mapped, controlData);
+        return true;
+    }
+
+    float input[MappingInputCount];
+    gamepad->GetMappingInput(input);
+
+    MappedControl mapped;
+#ifdef DRIVER_STATIC_BINDINGS
+    FlightBindings::Map(input, speedGears.Scale(), mapped);
+#else
+    MapControl(layer.mapping, input, speedGears.Scale(), mapped);
+#endif
+    if (layer.formulas.mask != 0) {
+        ExpressionInputs inputs;
+        inputs.input = input;
+        inputs.scale = speedGears.Scale();
+        inputs.buttons = 0;
+        for (int i = 0; i < Gamepad::ButtonCount; i++) {
+            inputs.buttons |= (gamepad->IsKeyPressed(i) ? 1u : 0u) << i;
+        }
+        EvaluateFormulas(layer.formulas, inputs, mapped);
+    }
+    if (mapped.activeMask == 0) {
+        return false;
+    }
+    ApplyMapping(layer.mapping, mapped, controlData);
+    return true;
 }
 
 void Application::SetDefaultDataForControlCommandSender() {
@@ -104,17 +265,130 @@ void Application::SetDefaultDataForControlCommandSender() {
     controlData.parameters[geo::Roll]   .frame = scene::Absent;
 }
 
+// Повтор неизменной команды с запасом до истечения time_limit на аппарате
+void Application::ConfigureControlPolicy()
+{
+    ControlPolicySettings policy;
+    policy.enabled = config->settings.control_dedup;
+    policy.tolerance = config->settings.control_tolerance;
+    double keepalive = controlSender->GetData().time_limit - config->settings.control_keepalive_margin;
+    // Подстроенный time_limit рассчитан на серию потерь, один повтор на лимит ее не переживет
+    if (config->settings.adapt_link) {
+        keepalive = linkAdapter.Keepalive();
+    }
+    policy.keepalive = static_cast<uint32_t>(std::max(keepalive, sendDataInterval) * 1000);
+    controlPolicy.Configure(policy);
+}
+
 void Application::Run()
 {
     ipc::Timer sendTimer(*core);
     ipc::Timer tmr_state(*core);
+    ipc::Timer sampleTimer(*core);
+    ipc::Timer criticalTimer(*core);
     sendTimer.start(sendDataInterval);
     tmr_state.start(sendStateInterval);
+    criticalTimer.start(criticalInterval);
+    if (sampleInterval > 0) {
+        sampleTimer.start(sampleInterval);
+    }
 
     SDL_Event event;
 
     while (core->receive()) {
+        // Новый снимок настроек подменяется только между тактами
+        if (DriverConfig* next = configReloader->TakeReady()) {
+            double dataInterval = sendDataInterval;
+            double stateInterval = sendStateInterval;
+            double samplesInterval = sampleInterval;
+            double retryInterval = criticalInterval;
+            ApplyConfig(next);
+            if (sendDataInterval != dataInterval) {
+                sendTimer.restart(sendDataInterval);
+            }
+            if (sendStateInterval != stateInterval) {
+                tmr_state.restart(sendStateInterval);
+            }
+            if (criticalInterval != retryInterval) {
+                criticalTimer.restart(criticalInterval);
+            }
+            if (sampleInterval != samplesInterval) {
+                if (sampleInterval > 0) {
+                    sampleTimer.restart(sampleInterval);
+                }
+                else {
+                    sampleTimer.stop();
+                }
+            }
+        }
+
+        if (reloadReceiver->received()) {
+            configReloader->Request();
+            continue;
+        }
+
+        if (pilotReceiver->received()) {
+            pilot = pilotReceiver->_.name.to_std_string();
+            SelectProfile();
+            continue;
+        }
+
+        // Получатель возвращает время отправки команды: RTT по своим же часам.
+        // По правилу Карна замер дает только первое подтверждение номера, ушедшего
+        // без повторов: копии остановки и второй путь несут то же время отправки.
+        if (ackReceiver->received()) {
+            const Message::ControlAck& ack = ackReceiver->_;
+            uint64_t now = MonotonicMicroseconds();
+            bool fresh = static_cast<int32_t>(ack.sequence - rttSequence) > 0;
+            bool retransmitted = ack.sequence == critical.Sequence() && critical.Retries() > 0;
+            if (fresh && ack.sent != 0 && now > ack.sent) {
+                rttSequence = ack.sequence;
+                if (!retransmitted) {
+                    linkAdapter.RttSample((now - ack.sent) / 1e6);
+                }
+            }
+            OnCriticalAck(ack.sequence, SDL_GetTicks());
+            continue;
+        }
+
+        // Work не несет номера: подтверждает ожидаемую остановку, если модуль движения
+        // исполняет команду нашего приоритета. Слабее ControlAck, включается настройкой.
+        if (workReceiver->received()) {
+            bool ours = workReceiver->_.priority == controlSender->GetData().priority;
+            loopLatency.WorkReceived(ours);
+            if (config->settings.critical_ack_work && critical.IsPending() && ours) {
+                OnCriticalAck(critical.Sequence(), SDL_GetTicks());
+            }
+            continue;
+        }
+
+        if (forcesReceiver->received()) {
+            loopLatency.ForcesReceived(forcesReceiver->_, MonotonicMicroseconds());
+            continue;
+        }
+
+        if (criticalTimer.received()) {
+            ResendCritical(SDL_GetTicks());
+            continue;
+        }
+
+        // Получатель сообщает, что дошло; показываем в состоянии как есть
+        // и по этому же отчету подстраиваем период посылки
+        if (linkReceiver->received()) {
+            programStateSender->GetData().link = linkReceiver->_;
+            if (config->settings.adapt_link) {
+                double dataInterval = sendDataInterval;
+                OnLinkDiagnostics(linkReceiver->_);
+                if (sendDataInterval != dataInterval) {
+                    sendTimer.restart(sendDataInterval);
+                }
+            }
+            continue;
+        }
+
         if (tmr_state.received()) {
+            configReloader->PollFiles();
+            UpdateProgramState();
             programStateSender->Send();
             // Только одно событие в итерации цикла!
             continue;
@@ -122,19 +396,138 @@ void Application::Run()
 
         PollEvents(event);
 
+        if (sampleTimer.received()) {
+            SampleControl(SDL_GetTicks());
+            continue;
+        }
+
         if (sendTimer.received() && isGamepadAvailable) {
             gamepad->ProcessPendingKeyEvents();
-            Message::GamepadState& gamepadState = gamepadStateSender->GetData();
-            for (int i = 0; i < Gamepad::AxisCount; i++) {
+            Uint32 now = SDL_GetTicks();
+            gamepad->CloseAxisWindows(now);
+            gamepad->UpdateNoiseEstimate();
+            gamepad->UpdatePredictors(now);
+            PublishGamepadState(now);
+            ProcessCommands(now);
+            continue;
+        }
+    }
+}
+
+// Состояние геймпада уходит только при изменении или по истечении периода повтора:
+// компактная телеметрия всегда, прежнее GamepadState - в режиме совместимости
+void Application::PublishGamepadState(Uint32 now)
+{
+    const uint32_t buttons = gamepad->DirtyButtons();
+    const uint32_t axes = gamepad->DirtyAxes();
+    const bool compat = config->settings.gamepad_state_compat;
+    const double keepalive = config->settings.gamepad_keepalive;
+    const bool expired = now - gamepadStatePublished >= static_cast<Uint32>(keepalive * 1000);
+    if (buttons == 0 && axes == 0 && !expired) {
+        gamepadTelemetryStats.Skipped(now, sizeof(Message::GamepadTelemetry));
+        if (compat) {
+            gamepadStateStats.Skipped(now, sizeof(Message::GamepadState));
+        }
+        return;
+    }
+
+    Message::GamepadTelemetry& telemetry = gamepadTelemetrySender->GetData();
+    telemetry.sequence = ++gamepadTelemetrySequence;
+    telemetry.timestamp = now;
+    telemetry.buttons = 0;
+    for (int i = 0; i < Gamepad::ButtonCount; i++) {
+        telemetry.buttons |= (gamepad->IsKeyPressed(i) ? 1u : 0u) << i;
+    }
+    for (int i = 0; i < SDL_CONTROLLER_AXIS_MAX; i++) {
+        telemetry.axes[i] = gamepad->GetAxisQ15(i);
+    }
+    gamepadTelemetrySender->Send();
+    gamepadTelemetryStats.Sent(now, sizeof(Message::GamepadTelemetry));
+
+    if (compat) {
+        Message::GamepadState& gamepadState = gamepadStateSender->GetData();
+        for (int i = 0; i < Gamepad::AxisCount; i++) {
+            if (gamepadStateStale || ((axes >> i) & 1u)) {
                 gamepadState.axesState[i].value = gamepad->GetValueForAxis(Axis(i));
             }
-            for (int i = 0; i < Gamepad::ButtonCount; i++) {
+        }
+        for (int i = 0; i < Gamepad::ButtonCount; i++) {
+            if (gamepadStateStale || ((buttons >> i) & 1u)) {
                 gamepadState.buttonStates[i].isPressed = gamepad->IsKeyPressed(i);
             }
-            gamepadStateSender->Send();
-            ProcessCommands();
-            continue;
         }
+        gamepadStateSender->Send();
+        gamepadStateStats.Sent(now, sizeof(Message::GamepadState));
+    }
+    gamepadStateStale = !compat;
+
+    gamepad->ClearDirty();
+    gamepadStatePublished = now;
+}
+
+void Application::UpdateProgramState()
+{
+    Message::State& programState = programStateSender->GetData();
+    programState.gear = speedGears.Current() + 1;
+    MacroPlayer::Mode macroMode = macroPlayer.GetMode();
+    programState.macro_recording = macroMode == MacroPlayer::Mode::Recording ? macroPlayer.Slot() + 1 : 0;
+    programState.macro_playing   = macroMode == MacroPlayer::Mode::Playing ? macroPlayer.Slot() + 1 : 0;
+
+    const ReloadStats& reload = configReloader->Stats();
+    char checksum[9];
+    snprintf(checksum, sizeof(checksum), "%08x", static_cast<unsigned>(reload.checksum));
+    programState.config.version    = static_cast<int>(reload.version);
+    programState.config.checksum   = checksum;
+    programState.config.reloads    = reload.reloads;
+    programState.config.unchanged  = reload.unchanged;
+    programState.config.latency    = reload.latency;
+    programState.config.build_time = reload.buildTime;
+
+    Uint32 now = SDL_GetTicks();
+    programState.gamepad_state.sent          = static_cast<int>(gamepadStateStats.SentMessages(now));
+    programState.gamepad_state.skipped       = static_cast<int>(gamepadStateStats.SkippedMessages(now));
+    programState.gamepad_state.sent_bytes    = static_cast<double>(gamepadStateStats.SentBytes(now));
+    programState.gamepad_state.skipped_bytes = static_cast<double>(gamepadStateStats.SkippedBytes(now));
+    programState.gamepad_telemetry.sent          = static_cast<int>(gamepadTelemetryStats.SentMessages(now));
+    programState.gamepad_telemetry.skipped       = static_cast<int>(gamepadTelemetryStats.SkippedMessages(now));
+    programState.gamepad_telemetry.sent_bytes    = static_cast<double>(gamepadTelemetryStats.SentBytes(now));
+    programState.gamepad_telemetry.skipped_bytes = static_cast<double>(gamepadTelemetryStats.SkippedBytes(now));
+    programState.control.sent          = static_cast<int>(controlStats.SentMessages(now));
+    programState.control.skipped       = static_cast<int>(controlStats.SkippedMessages(now));
+    programState.control.sent_bytes    = static_cast<double>(controlStats.SentBytes(now));
+    programState.control.skipped_bytes = static_cast<double>(controlStats.SkippedBytes(now));
+    programState.control_bundle.sent       = static_cast<int>(bundleStats.SentMessages(now));
+    programState.control_bundle.sent_bytes = static_cast<double>(bundleStats.SentBytes(now));
+    programState.control_udp.sent          = static_cast<int>(udpStats.SentMessages(now));
+    programState.control_udp.skipped       = static_cast<int>(udpStats.SkippedMessages(now));
+    programState.control_udp.sent_bytes    = static_cast<double>(udpStats.SentBytes(now));
+    programState.control_udp.skipped_bytes = static_cast<double>(udpStats.SkippedBytes(now));
+    programState.adapt.interval   = sendDataInterval;
+    programState.adapt.time_limit = controlSender->GetData().time_limit;
+    programState.adapt.rtt        = linkAdapter.Rtt() * 1000;
+    programState.adapt.loss       = linkLoss;
+    programState.adapt.queue      = linkQueue;
+    programState.adapt.congested  = linkAdapter.IsCongested();
+
+    const LatencyHistogram& loop = loopLatency.Histogram();
+    loopLatency.Expire(MonotonicMicroseconds());
+    programState.loop.samples  = static_cast<int>(loop.Count());
+    programState.loop.timeouts = static_cast<int>(loopLatency.Timeouts());
+    programState.loop.mean     = loop.Mean() / 1000;
+    programState.loop.p50      = loop.Percentile(0.5) / 1000.0;
+    programState.loop.p90      = loop.Percentile(0.9) / 1000.0;
+    programState.loop.p99      = loop.Percentile(0.99) / 1000.0;
+    programState.loop.max      = loop.Max() / 1000.0;
+
+    for (int i = 0; i < Gamepad::AxisCount; i++) {
+        const NoiseEstimator& estimate = gamepad->GetNoiseEstimate(Axis(i));
+        programState.axesNoise[i].drift    = estimate.Drift();
+        programState.axesNoise[i].noise    = estimate.Noise();
+        programState.axesNoise[i].deadzone = static_cast<double>(estimate.Deadzone()) / Q15One;
+
+        const AxisPredictor& predictor = gamepad->GetPredictor(Axis(i));
+        programState.axesPrediction[i].error      = predictor.PredictionError();
+        programState.axesPrediction[i].hold_error = predictor.HoldError();
     }
 }
 
@@ -155,12 +548,19 @@ void Application::PollEvents(SDL_Event &event)
                 gamepad->SetButtonState(SDL_GameControllerButton(event.cbutton.button), false);
                 break;
             case SDL_CONTROLLERAXISMOTION:
-                gamepad->SetAxisValue((Axis)event.caxis.axis, event.caxis.value);
+                gamepad->SetAxisValue((Axis)event.caxis.axis, event.caxis.value, event.caxis.timestamp);
                 break;
         }
     }
 }
 
+static std::string DeviceGuid(int deviceIndex)
+{
+    char guid[33];
+    SDL_JoystickGetGUIDString(SDL_JoystickGetDeviceGUID(deviceIndex), guid, sizeof(guid));
+    return guid;
+}
+
 void Application::OnJoystickConnected(int deviceIndex)
 {
     if (!SDL_IsGameController(deviceIndex)) {
@@ -169,12 +569,19 @@ void Application::OnJoystickConnected(int deviceIndex)
     if (!isGamepadAvailable) {
         gamepad->Open(deviceIndex);
         isGamepadAvailable = true;
+        deviceGuid = DeviceGuid(deviceIndex);
+        SelectProfile();
         ToggleInputControl(false);
         std::cout << "Gamepad connected." << std::endl;
         if (gamepadStateSender == nullptr) {
             gamepadStateSender = new Sender<Message::GamepadState>(core);
             gamepadStateSender->Initialize();
+            gamepadTelemetrySender = new Sender<Message::GamepadTelemetry>(core);
+            gamepadLayoutSender = new Sender<Message::GamepadLayout>(core);
+            gamepadLayoutSender->Initialize();
         }
+        // Имена кнопок и осей уходят один раз на подключение, дальше только телеметрия
+        gamepadLayoutSender->Send();
         core->log("Устройство подключено");
     }
 }
@@ -182,6 +589,22 @@ void Application::OnJoystickConnected(int deviceIndex)
 void Application::ToggleInputControl(bool value)
 {
     isControlEnable = value;
+    if (value) {
+        // Первая команда после включения уходит без сверки с отправленной до отключения
+        controlPolicy.Reset();
+    }
+    else {
+        // Удержание торможения не переживает отключение управления, передача сохраняется
+        zeroSpeedHeld = false;
+        macroPlayer.Cancel();
+        if (macroPlayer.GetMode() == MacroPlayer::Mode::Recording) {
+            // Прерванная запись не сохраняется: слот возвращается к своему файлу
+            int interrupted = macroPlayer.Slot();
+            macroPlayer.StopRecording();
+            macros[interrupted].Load(MacroPath(interrupted));
+            core->log("Запись макроса " + std::to_string(interrupted + 1) + " прервана");
+        }
+    }
 }
 
 void Application::OnJoystickDisconnected()
@@ -191,6 +614,7 @@ void Application::OnJoystickDisconnected()
         core->log("Устройство отключено");
         gamepad->Close();
         isGamepadAvailable = false;
+        deviceGuid.clear();
         ToggleInputControl(false);
         for (int i = 0; i < SDL_NumJoysticks(); i++) {
             if (!SDL_IsGameController(i)) {
@@ -198,106 +622,450 @@ void Application::OnJoystickDisconnected()
             }
             if (gamepad->Open(i)) {
                 isGamepadAvailable = true;
+                deviceGuid = DeviceGuid(i);
+                SelectProfile();
+                gamepadLayoutSender->Send();
                 return;
             }
         }
     }
 }
 
-void Application::ProcessCommands()
+// Профиль готов заранее: пересборка идет в потоке, снимок подменяется между тактами
+void Application::SelectProfile()
 {
-    commandsHandler.ExecuteCommands();
+    int index = profileStore.Select(pilot, deviceGuid);
+    configReloader->UseProfile(index >= 0 ? &profileStore.Get(index) : nullptr);
+    configReloader->Request();
+
+    Message::State& programState = programStateSender->GetData();
+    programState.pilot = pilot;
+    programState.device = deviceGuid;
 }
 
-bool Application::IsControlEnable() const
+void Application::ProcessCommands(Uint32 now)
 {
-    return isControlEnable;
-}
+    tickTime = now;
 
-void Application::CreateCommands() {
-    commandsHandler.Add(
-        [this]() {
-        if (gamepad->WasKeyPressed(Commands::start_control.bindingKey)) {
-            gamepad->ConsumeKey(Commands::start_control.bindingKey);
-            ToggleInputControl(true);
-            std::cout << "Control on" << std::endl;
-            core->log("Управление включено");
-        }
-        return;
+#ifdef DRIVER_STATIC_BINDINGS
+    FlightBindings::Dispatch(gamepad->GetInputChanges(), [this](const CommandDescriptor& command, bool pressed) {
+        ExecuteCommand(command, pressed);
     });
-    commandsHandler.Add(
-        [this]() {
-        if (gamepad->WasKeyPressed(Commands::stop_control.bindingKey)) {
-            gamepad->ConsumeKey(Commands::stop_control.bindingKey);
-            ToggleInputControl(false);
-            std::cout << "Control off" << std::endl;
-            core->log("Управление отключено");
-        }
+#else
+    config->layers[activeLayer].commands.ExecuteCommands(gamepad->GetInputChanges());
+#endif
+    if (zeroSpeedHeld && !IsTriggerActive(zeroSpeedTrigger, zeroSpeedBinding)) {
+        zeroSpeedHeld = false;
+    }
+
+    if (!IsControlEnable()) {
         return;
-    });
-    commandsHandler.Add(
-        [this]() {
-        if (!IsControlEnable()) {
+    }
+
+    if (macroPlayer.GetMode() == MacroPlayer::Mode::Playing) {
+        // Любое отклонение ручки или торможение забирает управление у макроса
+        if (zeroSpeedHeld || IsAnyAxisActive()) {
+            macroPlayer.Cancel();
+            core->log("Макрос прерван");
+        }
+        else {
+            if (const MacroFrame* frame = macroPlayer.Next(now)) {
+                ControlMacro::Apply(*frame, controlSender->GetData());
+                PublishControl(now);
+                SetDefaultDataForControlCommandSender();
+            }
             return;
         }
+    }
 
-        bool hasChanges = false;
+    if (zeroSpeedHeld) {
+        SetDefaultDataForControlCommandSender();
+        SendControl(now);
+        return;
+    }
 
-        if (gamepad->WasKeyPressed(Commands::set_zero_speed.bindingKey)) {
-            hasChanges = true;
-            SetDefaultDataForControlCommandSender();
-            controlSender->Send();
-            return;
-        }
+    if (MapControlCommand()) {
+        SendControl(now);
+        SetDefaultDataForControlCommandSender();
+    }
+    else if (controlPolicy.IsNeutralPending()) {
+        // Ручки вернулись в ноль: нулевая команда сразу, а не по истечении time_limit
+        SendControl(now);
+    }
+}
+
+void Application::SendControl(Uint32 now)
+{
+    macroPlayer.Record(controlSender->GetData(), now);
+    PublishControl(now);
+}
+
+// Повторы в пределах допуска не уходят на шину, но учитываются в скорости до отсева
+void Application::PublishControl(Uint32 now)
+{
+    if (!controlPolicy.Accept(controlSender->GetData(), now)) {
+        controlStats.Skipped(now, sizeof(motion::Control));
+        return;
+    }
 
-        double speed_coeff = 1;
-        double force_up = 25;
-        double force_pitch = 7.5;
+    // Движение отменяет ожидание подтверждения остановки, нулевая команда - нет
+    if (critical.IsPending() && !ControlSendPolicy::IsNeutral(controlSender->GetData())) {
+        critical.Supersede();
+        ReportCritical();
+    }
 
-        if (gamepad->WasKeyPressed(Commands::set_min_speed.bindingKey)) {
-            speed_coeff = 0.2;
-        }
-        if (gamepad->WasKeyPressed(Commands::set_slow_speed.bindingKey)) {
-            speed_coeff = 0.5;
+    Message::Stamp& stamp = controlStampSender->GetData().stamp;
+    stamp.sequence = ++controlSequence;
+    stamp.timestamp = MonotonicMicroseconds();
+    loopLatency.ControlSent(controlSender->GetData(), stamp.timestamp);
+    DeliverControl(now, config->settings.control_redundant);
+}
+
+void Application::DeliverControl(Uint32 now, bool redundant)
+{
+    const Message::Stamp& stamp = controlStampSender->GetData().stamp;
+
+    // Прямой путь мимо шины; шина остается запасной, если UDP выключен или сокет не принял кадр.
+    // При дублировании шина - второй независимый путь, лишнюю копию отбрасывает получатель.
+    bool udpSent = false;
+    if (config->settings.udp_control) {
+        udpSent = SendControlFrame(stamp);
+        if (udpSent) {
+            udpStats.Sent(now, ControlFrameSize);
         }
-        if (gamepad->WasKeyPressed(Commands::set_max_speed.bindingKey)) {
-            speed_coeff = 2;
+        else {
+            udpStats.Skipped(now, ControlFrameSize);
         }
+    }
+    if (!udpSent || redundant) {
+        controlStampSender->GetData().checksum = ControlChecksum(controlSender->GetData());
+        controlSender->Send();
+        controlStampSender->Send();
+        controlStats.Sent(now, sizeof(motion::Control));
+    }
+}
+
+bool Application::SendControlFrame(const Message::Stamp& stamp)
+{
+    ControlFrameHeader header;
+    header.sequence = stamp.sequence;
+    header.timestamp = stamp.timestamp;
+    uint8_t frame[ControlFrameSize];
+    EncodeControlFrame(controlSender->GetData(), header, frame);
+    int64_t sent = udpSender->sendto(reinterpret_cast<const char*>(frame), ControlFrameSize,
+                                     udpHost, static_cast<uint16_t>(config->settings.udp_port));
+    return sent == static_cast<int64_t>(ControlFrameSize);
+}
+
+// Остановка уходит всеми путями пачкой копий с одним номером и повторяется до подтверждения
+void Application::SendCritical(Uint32 now)
+{
+    SetDefaultDataForControlCommandSender();
+    controlPolicy.Accept(controlSender->GetData(), now);
+
+    Message::Stamp& stamp = controlStampSender->GetData().stamp;
+    stamp.sequence = ++controlSequence;
+    stamp.timestamp = MonotonicMicroseconds();
+    criticalStamp = stamp;
+    loopLatency.ControlSent(controlSender->GetData(), stamp.timestamp);
+    critical.Start(stamp.sequence, now);
+    programStateSender->GetData().critical.sent++;
+    ResendCritical(now);
+}
+
+void Application::ResendCritical(Uint32 now)
+{
+    bool pending = critical.IsPending();
+    int copies = critical.Due(now);
+    if (pending && !critical.IsPending()) {
+        ReportCritical();
+        return;
+    }
+    if (copies == 0) {
+        return;
+    }
 
-        motion::Control& controlData = controlSender->GetData();
-        controlData.parameters[geo::Up].value = force_up;
-        controlData.parameters[geo::Up].type  = motion::ControlType::Force;
-        controlData.parameters[geo::Up].frame = scene::Absent;
+    // Между тактами в отправителе нулевая команда; метка - исходная, копии получатель отбросит
+    SetDefaultDataForControlCommandSender();
+    controlStampSender->GetData().stamp = criticalStamp;
+    for (int i = 0; i < copies; i++) {
+        DeliverControl(now, true);
+    }
+}
 
-        controlData.parameters[geo::Pitch].value = force_pitch;
-        controlData.parameters[geo::Pitch].type  = motion::ControlType::Force;
-        controlData.parameters[geo::Pitch].frame = scene::Absent;
+void Application::OnCriticalAck(uint32_t sequence, Uint32 now)
+{
+    if (critical.Acknowledge(sequence, now)) {
+        ReportCritical();
+    }
+}
 
-        if (gamepad->HasValueForAxis((Axis)Commands::move_forward.bindingAxis)) {
-            double velocity_forward = -gamepad->GetValueForAxis((Axis)Commands::move_forward.bindingAxis) * 5 * speed_coeff;
+// Потери считаются по приращению счетчиков получателя за период отчета;
+// уменьшение счетчиков - перезапуск получателя, отсчет идет заново.
+// Первый отчет после настройки подстройки только запоминает счетчики.
+void Application::OnLinkDiagnostics(const Message::LinkDiagnostics& link)
+{
+    const Message::StreamStats& delivered = link.delivered;
+    if (!linkBaseline) {
+        linkReceived = delivered.received;
+        linkLost = delivered.lost;
+        linkBaseline = true;
+        return;
+    }
+    int received = delivered.received - linkReceived;
+    int lost = delivered.lost - linkLost;
+    if (received < 0 || lost < 0) {
+        received = delivered.received;
+        lost = delivered.lost;
+    }
+    linkReceived = delivered.received;
+    linkLost = delivered.lost;
+    linkLoss = received + lost > 0 ? static_cast<double>(lost) / (received + lost) : 0;
+    linkQueue = link.queue_depth;
 
-            controlData.parameters[geo::Forward].value = velocity_forward;
-            controlData.parameters[geo::Forward].type  = motion::ControlType::Velocity;
-            controlData.parameters[geo::Forward].frame = scene::Absent;
+    if (!linkAdapter.Update(linkLoss, linkQueue)) {
+        return;
+    }
+    sendDataInterval = linkAdapter.Interval();
+    controlSender->GetData().time_limit = linkAdapter.TimeLimit();
+    ConfigureControlPolicy();
+}
 
-            hasChanges = true;
+void Application::ReportCritical()
+{
+    Message::CriticalState& state = programStateSender->GetData().critical;
+    std::string sequence = std::to_string(critical.Sequence());
+    std::string retries = std::to_string(critical.Retries());
+    switch (critical.LastResult()) {
+        case CriticalDelivery::Result::Acknowledged: {
+            double ackTime = critical.AckTime() / 1000.0;
+            state.acknowledged++;
+            state.last_ack_time = ackTime;
+            state.max_ack_time = std::max(state.max_ack_time, ackTime);
+            std::cout << "Stop " << sequence << " acknowledged in " << critical.AckTime()
+                      << " ms, retries " << retries << std::endl;
+            core->log("Остановка " + sequence + " подтверждена за " + std::to_string(critical.AckTime())
+                      + " мс, повторов " + retries);
+            break;
         }
-        if (gamepad->HasValueForAxis((Axis)Commands::move_right.bindingAxis)) {
-            double velocity_yaw = gamepad->GetValueForAxis((Axis)Commands::move_right.bindingAxis) * 5 * speed_coeff;
+        case CriticalDelivery::Result::Superseded:
+            state.superseded++;
+            core->log("Остановка " + sequence + " отменена новой командой, повторов " + retries);
+            break;
+        case CriticalDelivery::Result::Failed:
+            state.failed++;
+            std::cout << "Stop " << sequence << " not acknowledged after " << retries << " retries" << std::endl;
+            core->log("Остановка " + sequence + " не подтверждена, повторов " + retries);
+            break;
+        default:
+            break;
+    }
+    state.last_retries = critical.Retries();
+}
 
-            controlData.parameters[geo::Yaw].value = velocity_yaw;
-            controlData.parameters[geo::Yaw].type  = motion::ControlType::Velocity;
-            controlData.parameters[geo::Yaw].frame = scene::Absent;
+// Отсчет для пакета снимается с частотой sample_rate по той же раскладке, что и motion::Control.
+// Пока ручки в нуле, пакеты не идут; первый нулевой отсчет после движения уходит сразу.
+void Application::SampleControl(Uint32 now)
+{
+    if (!isGamepadAvailable || !IsControlEnable() || macroPlayer.GetMode() == MacroPlayer::Mode::Playing) {
+        if (bundler.Count() > 0) {
+            FlushBundle(now);
+        }
+        sampleActive = false;
+        return;
+    }
 
-            hasChanges = true;
+    bool active = !zeroSpeedHeld && MapControlCommand();
+    if (!active) {
+        SetDefaultDataForControlCommandSender();
+    }
+    if (active || sampleActive) {
+        const motion::Control& control = controlSender->GetData();
+        if (!bundler.Fits(control)) {
+            FlushBundle(now);
+        }
+        bundler.Add(control, MonotonicMicroseconds());
+        if (bundler.IsFull() || !active) {
+            FlushBundle(now);
         }
+    }
+    sampleActive = active;
+    SetDefaultDataForControlCommandSender();
+}
 
+void Application::FlushBundle(Uint32 now)
+{
+    bundler.Flush(bundleSender->GetData());
+    bundleSender->Send();
+    bundleStats.Sent(now, sizeof(Message::ControlBundle));
+}
 
-        if (hasChanges) {
-            controlSender->Send();
-            SetDefaultDataForControlCommandSender();
+// Все оси, включая курки: ими тоже отдают команды (слой стрейфа, формула крена)
+bool Application::IsAnyAxisActive()
+{
+    for (int i = 0; i < SDL_CONTROLLER_AXIS_MAX; i++) {
+        if (gamepad->HasValueForAxis(Axis(i))) {
+            return true;
         }
+    }
+    return false;
+}
+
+bool Application::IsControlEnable() const
+{
+    return isControlEnable;
+}
+
+void Application::ExecuteCommand(const CommandDescriptor& command, bool pressed)
+{
+    // Передача держится до переключения, торможение - пока кнопка удерживается
+    switch (command.action) {
+        case CommandAction::StartControl:
+            if (!pressed) {
+                break;
+            }
+            ToggleInputControl(true);
+            std::cout << "Control on" << std::endl;
+            core->log("Управление включено");
+            break;
+        case CommandAction::StopControl:
+            if (!pressed) {
+                break;
+            }
+            if (IsControlEnable()) {
+                SendCritical(SDL_GetTicks());
+            }
+            ToggleInputControl(false);
+            std::cout << "Control off" << std::endl;
+            core->log("Управление отключено");
+            break;
+        case CommandAction::SetGear:
+            if (pressed) {
+                OnGearChanged(speedGears.Select(static_cast<int>(command.value) - 1));
+            }
+            break;
+        case CommandAction::GearUp:
+            if (pressed) {
+                OnGearChanged(speedGears.Shift(1));
+            }
+            break;
+        case CommandAction::GearDown:
+            if (pressed) {
+                OnGearChanged(speedGears.Shift(-1));
+            }
+            break;
+        case CommandAction::ZeroSpeed:
+            if (pressed && !zeroSpeedHeld && IsControlEnable()) {
+                SendCritical(SDL_GetTicks());
+            }
+            if (pressed) {
+                zeroSpeedTrigger = command.trigger;
+                zeroSpeedBinding = command.binding;
+            }
+            zeroSpeedHeld = pressed;
+            break;
+        case CommandAction::RecordMacro:
+            if (pressed) {
+                ToggleMacroRecording(static_cast<int>(command.value) - 1);
+            }
+            break;
+        case CommandAction::PlayMacro:
+            if (pressed) {
+                StartMacro(static_cast<int>(command.value) - 1);
+            }
+            break;
+        case CommandAction::ShiftLayer:
+            if (pressed) {
+                shiftedLayer = command.target;
+            }
+            else if (shiftedLayer == command.target) {
+                shiftedLayer = -1;
+            }
+            UpdateLayer();
+            break;
+        case CommandAction::ToggleLayer:
+            if (pressed) {
+                toggledLayer = toggledLayer == command.target ? 0 : command.target;
+                UpdateLayer();
+            }
+            break;
+        default:
+            break;
+    }
+}
 
+void Application::OnGearChanged(bool changed)
+{
+    if (!changed) {
         return;
-    });
+    }
+    std::cout << "Gear " << speedGears.Current() + 1 << std::endl;
+    core->log("Передача " + std::to_string(speedGears.Current() + 1));
+    programStateSender->GetData().gear = speedGears.Current() + 1;
+}
+
+void Application::ToggleMacroRecording(int slot)
+{
+    if (slot < 0 || slot >= MacroSlots) {
+        return;
+    }
+    if (macroPlayer.GetMode() == MacroPlayer::Mode::Recording) {
+        int recorded = macroPlayer.Slot();
+        macroPlayer.StopRecording();
+        bool saved = macros[recorded].Save(MacroPath(recorded));
+        std::cout << "Macro " << recorded + 1 << " recorded, " << macros[recorded].Count() << " frames" << std::endl;
+        core->log("Макрос " + std::to_string(recorded + 1) + " записан, кадров: "
+                  + std::to_string(macros[recorded].Count()) + (saved ? "" : ", не сохранен"));
+        return;
+    }
+    macroPlayer.StartRecording(&macros[slot], slot, tickTime);
+    core->log("Запись макроса " + std::to_string(slot + 1));
+}
+
+void Application::StartMacro(int slot)
+{
+    if (slot < 0 || slot >= MacroSlots || !IsControlEnable()) {
+        return;
+    }
+    if (macroPlayer.StartPlayback(&macros[slot], slot, tickTime)) {
+        core->log("Воспроизведение макроса " + std::to_string(slot + 1));
+    }
+}
+
+std::string Application::MacroPath(int slot) const
+{
+    return core->load_path() + "/Macro--" + std::to_string(slot + 1) + ".bin";
+}
+
+// Физическое состояние источника команды, независимо от активного слоя
+bool Application::IsTriggerActive(CommandTrigger trigger, int binding) const
+{
+    if (trigger == CommandTrigger::Button) {
+        return gamepad->IsKeyPressed(binding);
+    }
+    if (trigger == CommandTrigger::Axis) {
+        return gamepad->GetAxisQ15(binding) != 0;
+    }
+    return false;
+}
+
+void Application::UpdateLayer()
+{
+    int next = shiftedLayer >= 0 ? shiftedLayer : toggledLayer;
+    if (next >= config->layerCount) {
+        next = 0;
+    }
+    if (next == activeLayer) {
+        return;
+    }
+    bool initial = activeLayer < 0;
+    activeLayer = next;
+    // Торможение не сбрасывается: оно держится, пока нажата вызвавшая его кнопка,
+    // даже если ее отпускание придет уже в таблицу другого слоя
+
+    std::string name = activeLayer == 0 ? "base" : config->bindings.layers[activeLayer - 1].name.to_std_string();
+    programStateSender->GetData().layer = name;
+    if (!initial) {
+        core->log("Слой " + name);
+    }
 }
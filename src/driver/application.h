@@ -3,10 +3,21 @@
 #include <iostream>
 
 #include "gamepad.h"
+#include "linkadapter.h"
+#include "looplatency.h"
 #include "sender.h"
 #include "messages.h"
 #include "motion.h"
-#include "commandshandler.h"
+#include "configreloader.h"
+#include "controlbundle.h"
+#include "controlframe.h"
+#include "controlpolicy.h"
+#include "criticaldelivery.h"
+#include "profilestore.h"
+#include "macro.h"
+#include "sendstats.h"
+#include "speedgears.h"
+#include "flightbindings.h"
 
 #include "SDL2/SDL.h"
 #undef main
@@ -25,27 +36,105 @@ public:
 private:
     void OnJoystickConnected(int deviceIndex);
     void OnJoystickDisconnected();
+    void SelectProfile();
 
     void PollEvents(SDL_Event& event);
-    void ProcessCommands();
+    void UpdateProgramState();
+    void PublishGamepadState(Uint32 now);
+    void ProcessCommands(Uint32 now);
+    void SendControl(Uint32 now);
+    void PublishControl(Uint32 now);
+    void DeliverControl(Uint32 now, bool redundant);
+    bool SendControlFrame(const Message::Stamp& stamp);
+    void SendCritical(Uint32 now);
+    void ResendCritical(Uint32 now);
+    void OnCriticalAck(uint32_t sequence, Uint32 now);
+    void ReportCritical();
+    void OnLinkDiagnostics(const Message::LinkDiagnostics& link);
+    void SampleControl(Uint32 now);
+    void FlushBundle(Uint32 now);
+    bool IsAnyAxisActive();
 
     void SetDefaultDataForControlCommandSender();
     void ToggleInputControl(bool value);
 
-    void LoadGamepadBindings();
-    void CreateCommands();
+    void ApplyConfig(DriverConfig* next);
+    void ConfigureControlPolicy();
+    bool MapControlCommand();
+    void ExecuteCommand(const CommandDescriptor& command, bool pressed);
+    void OnGearChanged(bool changed);
+    void UpdateLayer();
+    bool IsTriggerActive(CommandTrigger trigger, int binding) const;
+    void ToggleMacroRecording(int slot);
+    void StartMacro(int slot);
+    std::string MacroPath(int slot) const;
 
     Gamepad* gamepad;
     ipc::Core* core;
     Sender<motion::Control>* controlSender = nullptr;
     Sender<Message::State>* programStateSender = nullptr;
     Sender<Message::GamepadState>* gamepadStateSender = nullptr;
+    Sender<Message::GamepadTelemetry>* gamepadTelemetrySender = nullptr;
+    Sender<Message::GamepadLayout>* gamepadLayoutSender = nullptr;
+    Sender<Message::ControlBundle>* bundleSender = nullptr;
+    Sender<Message::ControlStamp>* controlStampSender = nullptr;
+    ipc::Receiver<Message::Reload>* reloadReceiver = nullptr;
+    ipc::Receiver<Message::Pilot>* pilotReceiver = nullptr;
+    ipc::Receiver<Message::LinkDiagnostics>* linkReceiver = nullptr;
+    ipc::Receiver<Message::ControlAck>* ackReceiver = nullptr;
+    ipc::Receiver<motion::Work>* workReceiver = nullptr;
+    ipc::Receiver<motion::Forces>* forcesReceiver = nullptr;
+    ipc::UdpSocketSender* udpSender = nullptr;
 
     double sendStateInterval;
     double sendDataInterval;
+    double sampleInterval = 0;        // Период отсчетов для пакетов, 0 - пакеты выключены
+    double criticalInterval = 0.025;  // Проверка повтора остановки, вдвое чаще периода повтора
 
     bool isControlEnable = false;
     bool isGamepadAvailable = false;
 
-    CommandsHandler commandsHandler;
+    bool zeroSpeedHeld = false;
+    CommandTrigger zeroSpeedTrigger = CommandTrigger::None;   // Источник удержания торможения
+    int zeroSpeedBinding = -1;
+
+    int activeLayer = 0;
+    int toggledLayer = 0;
+    int shiftedLayer = -1;          // Слой удерживаемой кнопки сдвига, -1 - нет
+    Uint32 tickTime = 0;
+
+    ControlMacro* macros = nullptr;   // MacroSlots буферов, загружаются при запуске
+    MacroPlayer macroPlayer;
+
+    Uint32 gamepadStatePublished = 0;
+    uint32_t gamepadTelemetrySequence = 0;
+    bool gamepadStateStale = true;    // Прежнее сообщение не обновлялось, пока было выключено
+    SendStats gamepadStateStats;
+    SendStats gamepadTelemetryStats;
+    ControlSendPolicy controlPolicy;
+    SendStats controlStats;
+    SendStats udpStats;
+    uint32_t controlSequence = 0;     // Номер команды движения, общий для шины и UDP
+    std::string udpHost;
+    CriticalDelivery critical;
+    Message::Stamp criticalStamp;
+    LoopLatency loopLatency;
+    LinkAdapter linkAdapter;
+    double nominalTimeLimit = 2;      // time_limit из описания motion::Control, без подстройки
+    bool linkBaseline = false;        // Счетчики получателя запомнены после настройки подстройки
+    int linkReceived = 0;             // Счетчики получателя на прошлом отчете
+    int linkLost = 0;
+    uint32_t rttSequence = 0;         // Последний номер, давший замер RTT
+    double linkLoss = 0;
+    int linkQueue = 0;
+    ControlBundler bundler;
+    SendStats bundleStats;
+    bool sampleActive = false;        // Последний отсчет был ненулевым
+
+    ConfigReloader* configReloader = nullptr;
+    DriverConfig* config = nullptr;   // Действующий снимок, меняется только между тактами
+    ProfileStore profileStore;
+    std::string pilot;
+    std::string deviceGuid;           // GUID открытого пульта, пусто - не подключен
+    SpeedGears speedGears;
 };
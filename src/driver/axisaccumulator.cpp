@@ -0,0 +1,74 @@
+#include "axisaccumulator.h"
+
+#include <cstring>
+
+AxisSample AxisSampleFromString(const char* name)
+{
+    if (strcmp(name, "mean") == 0) {
+        return AxisSample::Mean;
+    }
+    if (strcmp(name, "peak") == 0) {
+        return AxisSample::Peak;
+    }
+    return AxisSample::Last;
+}
+
+void AxisAccumulator::Reset(int32_t value, uint32_t time)
+{
+    last = value;
+    lastTime = time;
+    windowStart = time;
+    weightedSum = 0;
+    minimum = maximum = value;
+    windowMean = windowMinimum = windowMaximum = value;
+}
+
+void AxisAccumulator::Add(int32_t value, uint32_t time)
+{
+    // События могут прийти с отметкой раньше закрытия предыдущего окна
+    if (time < lastTime) {
+        time = lastTime;
+    }
+
+    weightedSum += static_cast<int64_t>(last) * (time - lastTime);
+    last = value;
+    lastTime = time;
+
+    if (value < minimum) {
+        minimum = value;
+    }
+    if (value > maximum) {
+        maximum = value;
+    }
+}
+
+void AxisAccumulator::Close(uint32_t time)
+{
+    if (time < lastTime) {
+        time = lastTime;
+    }
+
+    weightedSum += static_cast<int64_t>(last) * (time - lastTime);
+    uint32_t duration = time - windowStart;
+
+    windowMean = duration > 0 ? static_cast<int32_t>(weightedSum / duration) : last;
+    windowMinimum = minimum;
+    windowMaximum = maximum;
+
+    windowStart = lastTime = time;
+    weightedSum = 0;
+    minimum = maximum = last;
+}
+
+int32_t AxisAccumulator::Get(AxisSample sample) const
+{
+    switch (sample) {
+        case AxisSample::Mean:
+            return windowMean;
+        case AxisSample::Peak:
+            return windowMaximum >= -windowMinimum ? windowMaximum : windowMinimum;
+        case AxisSample::Last:
+        default:
+            return last;
+    }
+}
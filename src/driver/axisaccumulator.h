@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+
+// Какое значение оси берет команда управления за период посылки
+enum class AxisSample
+{
+    Last,   // Последний отсчет перед тиком
+    Mean,   // Среднее, взвешенное по времени удержания отсчета
+    Peak    // Экстремум с наибольшим модулем
+};
+
+AxisSample AxisSampleFromString(const char* name);
+
+// Накопитель значений одной оси между тиками управления.
+// Значение считается постоянным от события до следующего события,
+// окно закрывается методом Close в момент тика.
+// Считает в целых отсчетах оси, чтобы результат не зависел от сборки.
+class AxisAccumulator
+{
+public:
+    void Reset(int32_t value, uint32_t time);
+    void Add(int32_t value, uint32_t time);
+    void Close(uint32_t time);
+
+    int32_t Get(AxisSample sample) const;
+
+private:
+    int32_t last = 0;
+    uint32_t lastTime = 0;
+    uint32_t windowStart = 0;
+
+    int64_t weightedSum = 0;
+    int32_t minimum = 0;
+    int32_t maximum = 0;
+
+    int32_t windowMean = 0;
+    int32_t windowMinimum = 0;
+    int32_t windowMaximum = 0;
+};
@@ -0,0 +1,47 @@
+#include "commanddispatch.h"
+
+void CommandDispatcher::Build(const std::vector<CommandDescriptor>& descriptors)
+{
+    int counts[DispatchTriggerCount] = {};
+    for (const auto& descriptor : descriptors) {
+        // Осевое движение, постоянные задания и формулы считает таблица отображения, а не диспетчер
+        if (descriptor.action == CommandAction::Move || descriptor.action == CommandAction::Hold
+                || descriptor.action == CommandAction::Formula) {
+            continue;
+        }
+        counts[DispatchTriggerIndex(descriptor.trigger, descriptor.binding)]++;
+    }
+
+    offsets[0] = 0;
+    for (int i = 0; i < DispatchTriggerCount; i++) {
+        offsets[i + 1] = static_cast<uint16_t>(offsets[i] + counts[i]);
+    }
+
+    // Порядок команд одного триггера сохраняется как в конфигурации
+    commands.resize(offsets[DispatchTriggerCount]);
+    uint16_t next[DispatchTriggerCount];
+    for (int i = 0; i < DispatchTriggerCount; i++) {
+        next[i] = offsets[i];
+    }
+    for (const auto& descriptor : descriptors) {
+        if (descriptor.action == CommandAction::Move || descriptor.action == CommandAction::Hold
+                || descriptor.action == CommandAction::Formula) {
+            continue;
+        }
+        commands[next[DispatchTriggerIndex(descriptor.trigger, descriptor.binding)]++] = descriptor;
+    }
+}
+
+int CommandDispatcher::LowestBit(uint32_t bits)
+{
+#if defined(__GNUC__)
+    return __builtin_ctz(bits);
+#else
+    int index = 0;
+    while ((bits & 1u) == 0) {
+        bits >>= 1;
+        index++;
+    }
+    return index;
+#endif
+}
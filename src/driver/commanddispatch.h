@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "commands.h"
+
+// Индекс от кнопки или оси к списку привязанных к ней команд.
+// Обходятся только биты, изменившиеся за такт: такт без изменений ввода
+// не исполняет ни одной команды, нажатие исполняет только свои.
+
+const int DispatchButtonSlots = 24;   // >= SDL_CONTROLLER_BUTTON_MAX
+const int DispatchAxisSlots = 8;      // >= SDL_CONTROLLER_AXIS_MAX
+const int DispatchTriggerCount = DispatchButtonSlots + DispatchAxisSlots;
+
+inline int DispatchTriggerIndex(CommandTrigger trigger, int binding)
+{
+    return trigger == CommandTrigger::Button ? binding : DispatchButtonSlots + binding;
+}
+
+// Изменения ввода за такт: бит - индекс DispatchTriggerIndex
+struct DispatchMask
+{
+    uint32_t pressed = 0;
+    uint32_t released = 0;
+};
+
+class CommandDispatcher
+{
+public:
+    void Build(const std::vector<CommandDescriptor>& descriptors);
+
+    // execute(const CommandDescriptor&, bool pressed)
+    template <typename Executor>
+    void Dispatch(const DispatchMask& mask, Executor&& execute) const
+    {
+        DispatchEdges(mask.pressed, true, execute);
+        DispatchEdges(mask.released, false, execute);
+    }
+
+private:
+    template <typename Executor>
+    void DispatchEdges(uint32_t bits, bool pressed, Executor& execute) const
+    {
+        while (bits != 0) {
+            int trigger = LowestBit(bits);
+            bits &= bits - 1;
+            for (uint16_t i = offsets[trigger]; i < offsets[trigger + 1]; i++) {
+                execute(commands[i], pressed);
+            }
+        }
+    }
+
+    static int LowestBit(uint32_t bits);
+
+    // Команды, сгруппированные по триггеру: команды триггера t лежат в
+    // commands[offsets[t] .. offsets[t + 1])
+    uint16_t offsets[DispatchTriggerCount + 1] = {};
+    std::vector<CommandDescriptor> commands;
+};
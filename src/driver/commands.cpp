@@ -1,10 +1,271 @@
 #include "commands.h"
 
-KeyBinding Commands::start_control;
-KeyBinding Commands::stop_control;
-KeyBinding Commands::set_min_speed;
-KeyBinding Commands::set_slow_speed;
-KeyBinding Commands::set_max_speed;
-KeyBinding Commands::set_zero_speed;
-AxisBinding Commands::move_forward;
-AxisBinding Commands::move_right;
+#include <cstring>
+#include <iostream>
+
+#include "SDL2/SDL.h"
+#undef main
+
+#include "common/geo.h"
+
+namespace CommandAction {
+Enum FromString(const char* name)
+{
+    static const char* const names[Num] = {
+        "start_control", "stop_control", "set_gear", "gear_up", "gear_down", "zero_speed",
+        "record_macro", "play_macro", "shift_layer", "toggle_layer", "move", "hold", "formula"
+    };
+    for (int i = 0; i < Num; i++) {
+        if (strcmp(name, names[i]) == 0) {
+            return Enum(i);
+        }
+    }
+    return None;
+}
+}
+
+int SlotFromString(const char* name)
+{
+    static const char* const names[geo::Num] = {
+        "right", "forward", "up", "yaw", "pitch", "roll"
+    };
+    for (int i = 0; i < geo::Num; i++) {
+        if (strcmp(name, names[i]) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+motion::ControlType::Enum ControlTypeFromString(const char* name)
+{
+    if (strcmp(name, "force") == 0) {
+        return motion::ControlType::Force;
+    }
+    if (strcmp(name, "position") == 0) {
+        return motion::ControlType::Position;
+    }
+    if (name[0] == '\0' || strcmp(name, "velocity") == 0) {
+        return motion::ControlType::Velocity;
+    }
+    return motion::ControlType::None;
+}
+
+scene::Object FrameFromString(const char* name)
+{
+    static const char* const names[scene::OBJECTS] = {
+        "zero", "mission_north", "mission_direct", "task_north", "task_direct",
+        "seabed", "ice", "pinger_dock"
+    };
+    for (int i = 0; i < scene::OBJECTS; i++) {
+        if (strcmp(name, names[i]) == 0) {
+            return scene::Object(i);
+        }
+    }
+    if (name[0] == '\0' || strcmp(name, "absent") == 0) {
+        return scene::Absent;
+    }
+    return scene::OBJECTS;
+}
+
+int LayerFromString(const Message::GamepadBindings& bindings, const char* name)
+{
+    if (name[0] == '\0' || strcmp(name, "base") == 0) {
+        return 0;
+    }
+    for (int i = 0; i < LayerMax - 1; i++) {
+        if (bindings.layers[i].name.to_std_string() == name) {
+            return i + 1;
+        }
+    }
+    return -1;
+}
+
+int LayerCount(const Message::GamepadBindings& bindings)
+{
+    int count = 1;
+    while (count < LayerMax && !bindings.layers[count - 1].name.to_std_string().empty()) {
+        count++;
+    }
+    return count;
+}
+
+// Разбор записи конфигурации; false для записей, которые не попадают в таблицу
+static bool ParseEntry(const Message::GamepadBindings& bindings, const Message::CommandEntry& entry,
+                       CommandDescriptor& descriptor, Expression& expression)
+{
+    descriptor.action = CommandAction::FromString(entry.action.to_std_string().c_str());
+    if (descriptor.action == CommandAction::None) {
+        return false;
+    }
+
+    const std::string binding = entry.binding.to_std_string();
+    const std::string trigger = entry.trigger.to_std_string();
+    if (trigger == "none" || descriptor.action == CommandAction::Hold || descriptor.action == CommandAction::Formula) {
+        descriptor.trigger = CommandTrigger::None;
+        descriptor.binding = -1;
+    }
+    else if (trigger == "axis") {
+        descriptor.trigger = CommandTrigger::Axis;
+        descriptor.binding = SDL_GameControllerGetAxisFromString(binding.c_str());
+        if (descriptor.binding == SDL_CONTROLLER_AXIS_INVALID) {
+            return false;
+        }
+    }
+    else {
+        descriptor.trigger = CommandTrigger::Button;
+        descriptor.binding = SDL_GameControllerGetButtonFromString(binding.c_str());
+        if (descriptor.binding == SDL_CONTROLLER_BUTTON_INVALID) {
+            return false;
+        }
+    }
+
+    descriptor.sample = AxisSampleFromString(entry.sample.to_std_string().c_str());
+    descriptor.slot = SlotFromString(entry.slot.to_std_string().c_str());
+    descriptor.value = static_cast<float>(entry.value);
+    descriptor.gain = static_cast<float>(entry.invert ? -entry.gain : entry.gain);
+    descriptor.expo = static_cast<float>(entry.expo);
+    descriptor.type = ControlTypeFromString(entry.type.to_std_string().c_str());
+    descriptor.frame = FrameFromString(entry.frame.to_std_string().c_str());
+    descriptor.layer = LayerFromString(bindings, entry.layer.to_std_string().c_str());
+    descriptor.target = LayerFromString(bindings, entry.target.to_std_string().c_str());
+    descriptor.expression = -1;
+
+    if (descriptor.layer < 0) {
+        return false;
+    }
+    // Опечатка в типе или системе координат не должна молча превращаться в управление по скорости
+    if (descriptor.type == motion::ControlType::None) {
+        std::cerr << "Type \"" << entry.type.to_std_string() << "\" rejected: unknown control type" << std::endl;
+        return false;
+    }
+    if (descriptor.frame == scene::OBJECTS) {
+        std::cerr << "Frame \"" << entry.frame.to_std_string() << "\" rejected: unknown frame" << std::endl;
+        return false;
+    }
+    // Движение берет значение с оси, постоянное задание источника не имеет
+    if (descriptor.action == CommandAction::Move
+            && (descriptor.trigger != CommandTrigger::Axis || descriptor.slot < 0)) {
+        return false;
+    }
+    if (descriptor.action != CommandAction::Hold && descriptor.action != CommandAction::Formula
+            && descriptor.trigger == CommandTrigger::None) {
+        return false;
+    }
+    if ((descriptor.action == CommandAction::Hold || descriptor.action == CommandAction::Formula)
+            && descriptor.slot < 0) {
+        return false;
+    }
+    if (descriptor.action == CommandAction::Formula) {
+        std::string error;
+        if (!CompileExpression(entry.expression.to_std_string().c_str(), expression, error)) {
+            std::cerr << "Formula \"" << entry.expression.to_std_string() << "\" rejected: " << error << std::endl;
+            return false;
+        }
+    }
+    if ((descriptor.action == CommandAction::ShiftLayer || descriptor.action == CommandAction::ToggleLayer)
+            && descriptor.target < 0) {
+        return false;
+    }
+    return true;
+}
+
+static bool IsMappingAction(CommandAction::Enum action)
+{
+    return action == CommandAction::Move || action == CommandAction::Hold || action == CommandAction::Formula;
+}
+
+// Команда слоя заменяет базовую на той же кнопке или оси, отображение - на той же степени свободы
+static bool Overrides(const CommandDescriptor& command, const CommandDescriptor& base)
+{
+    if (IsMappingAction(command.action) && IsMappingAction(base.action) && command.slot == base.slot) {
+        return true;
+    }
+    return command.trigger != CommandTrigger::None
+        && command.trigger == base.trigger && command.binding == base.binding;
+}
+
+void CommandTable::Compile(const Message::GamepadBindings& bindings, int layer)
+{
+    Clear();
+
+    std::vector<CommandDescriptor> own;
+    std::vector<CommandDescriptor> base;
+    for (const auto& entry : bindings.commands) {
+        CommandDescriptor descriptor;
+        Expression expression;
+        if (!ParseEntry(bindings, entry, descriptor, expression)) {
+            continue;
+        }
+        if (descriptor.action == CommandAction::Formula && (descriptor.layer == layer || descriptor.layer == 0)) {
+            descriptor.expression = static_cast<int>(expressions.size());
+            expressions.push_back(expression);
+        }
+        if (descriptor.layer == layer) {
+            own.push_back(descriptor);
+        }
+        else if (descriptor.layer == 0) {
+            base.push_back(descriptor);
+        }
+    }
+
+    for (const auto& descriptor : base) {
+        bool overridden = false;
+        for (const auto& command : own) {
+            overridden = overridden || Overrides(command, descriptor);
+        }
+        if (!overridden) {
+            Add(descriptor);
+        }
+    }
+    for (const auto& descriptor : own) {
+        Add(descriptor);
+    }
+}
+
+void CommandTable::Clear()
+{
+    descriptors.clear();
+    expressions.clear();
+}
+
+void CommandTable::Add(const CommandDescriptor& descriptor)
+{
+    descriptors.push_back(descriptor);
+}
+
+const std::vector<CommandDescriptor>& CommandTable::Descriptors() const
+{
+    return descriptors;
+}
+
+void CommandTable::BuildMapping(MappingTable& mapping) const
+{
+    ClearMapping(mapping);
+
+    for (const auto& command : descriptors) {
+        geo::Axis slot = geo::Axis(command.slot);
+        if (command.action == CommandAction::Move) {
+            BindMappingAxis(mapping, slot, MappingSourceIndex(command.binding, command.sample),
+                            command.gain, command.expo, command.type, command.frame);
+        }
+        else if (command.action == CommandAction::Hold) {
+            BindMappingConstant(mapping, slot, command.value, command.type, command.frame);
+        }
+        else if (command.action == CommandAction::Formula) {
+            BindMappingFormula(mapping, slot, command.type, command.frame);
+        }
+    }
+}
+
+void CommandTable::BuildFormulas(FormulaTable& formulas) const
+{
+    ClearFormulas(formulas);
+
+    for (const auto& command : descriptors) {
+        if (command.action == CommandAction::Formula) {
+            formulas.formula[command.slot] = expressions[command.expression];
+            formulas.mask |= 1u << command.slot;
+        }
+    }
+}
@@ -1,26 +1,88 @@
 #pragma once
 
-#include "SDL2/SDL.h"
-#undef main
+#include <vector>
 
-struct KeyBinding {
-   SDL_GameControllerButton bindingKey;
+#include "axisaccumulator.h"
+#include "expression.h"
+#include "mapping.h"
+#include "messages.h"
+
+// Действия, которые может выполнять команда из таблицы привязок
+namespace CommandAction {
+enum Enum {
+    None = -1,
+    StartControl,   // start_control
+    StopControl,    // stop_control
+    SetGear,        // set_gear, value - номер передачи с единицы
+    GearUp,         // gear_up
+    GearDown,       // gear_down
+    ZeroSpeed,      // zero_speed
+    RecordMacro,    // record_macro, value - номер макроса; повторное нажатие заканчивает запись
+    PlayMacro,      // play_macro, value - номер макроса
+    ShiftLayer,     // shift_layer, слой target, пока кнопка удерживается
+    ToggleLayer,    // toggle_layer, переключает слой target и базовый
+    Move,           // move, ось на степень свободы slot с коэффициентом gain
+    Hold,           // hold, постоянное задание value на степень свободы slot
+    Formula,        // formula, значение slot по формуле expression
+    Num
 };
+Enum FromString(const char* name);
+}
 
-struct AxisBinding {
-    SDL_GameControllerAxis bindingAxis;
+enum class CommandTrigger
+{
+    Button,
+    Axis,
+    None            // Без источника: постоянные задания
+};
+
+// Скомпилированная команда: все строки конфигурации разобраны при загрузке
+struct CommandDescriptor
+{
+    CommandAction::Enum action;
+    CommandTrigger trigger;
+    int binding;        // SDL_GameControllerButton или SDL_GameControllerAxis
+    AxisSample sample;
+    int slot;           // geo::Axis
+    float value;
+    float gain;         // Со знаком с учетом инверсии
+    float expo;
+    motion::ControlType::Enum type;
+    scene::Object frame;
+    int layer;          // Слой, в котором объявлена команда, 0 - базовый
+    int target;         // Слой для shift_layer и toggle_layer
+    int expression;     // Индекс скомпилированной формулы в таблице, -1 - нет
 };
 
+const int LayerMax = 8;     // Базовый и до семи объявленных
 
-class Commands
+// Номер слоя по имени: пустое имя и base - базовый, неизвестное - -1
+int LayerFromString(const Message::GamepadBindings& bindings, const char* name);
+int LayerCount(const Message::GamepadBindings& bindings);
+
+int SlotFromString(const char* name);
+// Пустое имя - значение по умолчанию, неизвестное - ControlType::None и scene::OBJECTS
+motion::ControlType::Enum ControlTypeFromString(const char* name);
+scene::Object FrameFromString(const char* name);
+
+// Плоская таблица команд одного слоя, собранная из Message--GamepadBindings.json:
+// команды слоя и не перекрытые ими команды базового слоя.
+// Записи без действия, с неизвестной привязкой, типом или системой координат в таблицу не попадают,
+// как и формулы, не прошедшие компиляцию и проверку.
+class CommandTable
 {
 public:
-    static KeyBinding start_control;
-    static KeyBinding stop_control;
-    static KeyBinding set_min_speed;
-    static KeyBinding set_slow_speed;
-    static KeyBinding set_max_speed;
-    static KeyBinding set_zero_speed;
-    static AxisBinding move_forward;
-    static AxisBinding move_right;
+    void Compile(const Message::GamepadBindings& bindings, int layer = 0);
+    void Clear();
+    void Add(const CommandDescriptor& descriptor);
+
+    const std::vector<CommandDescriptor>& Descriptors() const;
+
+    // Таблица отображения из команд move, hold и formula
+    void BuildMapping(MappingTable& mapping) const;
+    void BuildFormulas(FormulaTable& formulas) const;
+
+private:
+    std::vector<CommandDescriptor> descriptors;
+    std::vector<Expression> expressions;
 };
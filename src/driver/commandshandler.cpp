@@ -3,3 +3,24 @@
 CommandsHandler::CommandsHandler()
 {
 }
+
+void CommandsHandler::Compile(const Message::GamepadBindings& bindings, int layer)
+{
+    table.Compile(bindings, layer);
+    dispatcher.Build(table.Descriptors());
+}
+
+const CommandTable& CommandsHandler::Table() const
+{
+    return table;
+}
+
+void CommandsHandler::SetExecutor(const std::function<void(const CommandDescriptor&, bool)>& executor)
+{
+    this->executor = executor;
+}
+
+void CommandsHandler::ExecuteCommands(const DispatchMask& changes) const
+{
+    dispatcher.Dispatch(changes, executor);
+}
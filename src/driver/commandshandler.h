@@ -1,23 +1,22 @@
 #pragma once
-#include <vector>
 #include <functional>
 
-#include "command.h"
+#include "commands.h"
+#include "commanddispatch.h"
 
 class CommandsHandler
 {
 public:
     CommandsHandler();
-    void Add(const std::function<void()>& action) {
-        commands.push_back({action});
-    }
-    void ExecuteCommands() {
-        for (const auto& command : commands){
-            command.Execute();
-        }
-    }
+
+    void Compile(const Message::GamepadBindings& bindings, int layer = 0);
+    const CommandTable& Table() const;
+
+    void SetExecutor(const std::function<void(const CommandDescriptor&, bool)>& executor);
+    void ExecuteCommands(const DispatchMask& changes) const;
 
 private:
-    std::vector<Command> commands;
+    CommandTable table;
+    CommandDispatcher dispatcher;
+    std::function<void(const CommandDescriptor&, bool)> executor;
 };
-
@@ -0,0 +1,173 @@
+#include "configreloader.h"
+
+#include <iostream>
+#include <sys/stat.h>
+
+ConfigReloader::ConfigReloader(ipc::Core& core, const Executor& executor)
+    : core(core)
+    , executor(executor)
+    , init(core)
+    , gamepadBindings(core)
+    , busy(false)
+    , again(false)
+    , profile(nullptr)
+    , ready(nullptr)
+    , activeChecksum(0)
+    , unchanged(0)
+{
+    files[0] = core.load_path() + "/Message--Init.json";
+    files[1] = core.load_path() + "/Message--GamepadBindings.json";
+    ReadModificationTimes(modified);
+}
+
+ConfigReloader::~ConfigReloader()
+{
+    if (worker.joinable()) {
+        worker.join();
+    }
+    delete ready.exchange(nullptr);
+}
+
+DriverConfig* ConfigReloader::LoadInitial()
+{
+    requestTime = std::chrono::steady_clock::now();
+    DriverConfig* config = Build(init._, gamepadBindings._);
+    ready.store(config);
+    return TakeReady();
+}
+
+// Загрузчики зарегистрированы в ядре IPC, поэтому перечитываются здесь, в основном
+// потоке; потоку сборки уходит копия
+void ConfigReloader::Request()
+{
+    requestTime = std::chrono::steady_clock::now();
+    const Profile* source = profile.load();
+    if (source == nullptr) {
+        init.reload();
+        gamepadBindings.reload();
+    }
+    {
+        std::lock_guard<std::mutex> lock(requestedLock);
+        CopyMessage(requested.settings, source != nullptr ? source->settings : init._);
+        CopyMessage(requested.bindings, source != nullptr ? source->bindings : gamepadBindings._);
+        requested.profile = source != nullptr ? source->name.to_std_string() : std::string();
+    }
+    again.store(true);
+    if (busy.exchange(true)) {
+        return;
+    }
+    if (worker.joinable()) {
+        worker.join();
+    }
+    worker = std::thread(&ConfigReloader::Rebuild, this);
+}
+
+void ConfigReloader::UseProfile(const Profile* profile)
+{
+    this->profile.store(profile);
+}
+
+bool ConfigReloader::PollFiles()
+{
+    time_t times[2];
+    if (!ReadModificationTimes(times)) {
+        return false;
+    }
+    if (times[0] == modified[0] && times[1] == modified[1]) {
+        return false;
+    }
+    modified[0] = times[0];
+    modified[1] = times[1];
+    // Профиль подменяет файлы load: их правка не действует, пока он выбран
+    if (const Profile* active = profile.load()) {
+        std::string name = active->name.to_std_string();
+        std::cout << "Load files changed, ignored while profile " << name << " is active" << std::endl;
+        core.log("Файлы load изменены, но действует профиль " + name);
+        return false;
+    }
+    Request();
+    return true;
+}
+
+DriverConfig* ConfigReloader::TakeReady()
+{
+    stats.unchanged = unchanged.load();
+
+    DriverConfig* config = ready.exchange(nullptr);
+    if (config == nullptr) {
+        return nullptr;
+    }
+    config->version = nextVersion++;
+    activeChecksum.store(config->checksum);
+
+    stats.version = config->version;
+    stats.checksum = config->checksum;
+    stats.reloads++;
+    stats.buildTime = config->buildTime;
+    stats.latency = std::chrono::duration<double>(std::chrono::steady_clock::now() - requestTime).count();
+    return config;
+}
+
+const ReloadStats& ConfigReloader::Stats() const
+{
+    return stats;
+}
+
+void ConfigReloader::Rebuild()
+{
+    for (;;) {
+        while (again.exchange(false)) {
+            RebuildOnce();
+        }
+        busy.store(false);
+        // Запрос мог прийти между последней проверкой и сбросом busy
+        if (!again.load() || busy.exchange(true)) {
+            return;
+        }
+    }
+}
+
+void ConfigReloader::RebuildOnce()
+{
+    {
+        std::lock_guard<std::mutex> lock(requestedLock);
+        CopyMessage(building.settings, requested.settings);
+        CopyMessage(building.bindings, requested.bindings);
+        building.profile = requested.profile;
+    }
+    const Message::Init& settings = building.settings;
+    const Message::GamepadBindings& bindings = building.bindings;
+
+    // Файлы вернулись к действующему виду: неразобранный более ранний снимок им уже не соответствует
+    if (DriverConfigChecksum(settings, bindings) == activeChecksum.load()) {
+        unchanged++;
+        delete ready.exchange(nullptr);
+        return;
+    }
+
+    DriverConfig* config = Build(settings, bindings);
+    config->profile = building.profile;
+    // Неразобранный снимок заменяется новым
+    delete ready.exchange(config);
+}
+
+DriverConfig* ConfigReloader::Build(const Message::Init& settings, const Message::GamepadBindings& bindings)
+{
+    DriverConfig* config = BuildDriverConfig(settings, bindings);
+    for (int i = 0; i < config->layerCount; i++) {
+        config->layers[i].commands.SetExecutor(executor);
+    }
+    return config;
+}
+
+bool ConfigReloader::ReadModificationTimes(time_t* times) const
+{
+    for (int i = 0; i < 2; i++) {
+        struct stat info;
+        if (stat(files[i].c_str(), &info) != 0) {
+            return false;
+        }
+        times[i] = info.st_mtime;
+    }
+    return true;
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "ipc.h"
+#include "driverconfig.h"
+#include "profilestore.h"
+
+struct ReloadStats
+{
+    uint32_t version = 0;
+    uint32_t checksum = 0;
+    int reloads = 0;            // Принятых перезагрузок
+    int unchanged = 0;          // Перечитано без изменений
+    double latency = 0;         // От запроса до подмены, с
+    double buildTime = 0;       // Сборка таблиц, с
+};
+
+// Перечитывает Message--Init.json и Message--GamepadBindings.json без
+// перезапуска. Файлы читаются в основном потоке, в отдельном идет только
+// сборка таблиц; готовый снимок передается основному циклу через атомарный
+// указатель и забирается между тактами.
+// Файлы опрашиваются по времени изменения (inotify нет под Windows).
+// Выбранный профиль подменяет файлы: снимок собирается из его структур.
+class ConfigReloader
+{
+public:
+    typedef std::function<void(const CommandDescriptor&, bool)> Executor;
+
+    ConfigReloader(ipc::Core& core, const Executor& executor);
+    ~ConfigReloader();
+
+    // Синхронная загрузка при запуске
+    DriverConfig* LoadInitial();
+
+    // Перечитывает файлы или берет выбранный профиль и запускает пересборку;
+    // запрос во время сборки выполнится после нее. Только из основного потока
+    void Request();
+    // Профиль из хранилища или nullptr для файлов load, вступает в силу через Request
+    void UseProfile(const Profile* profile);
+    // Проверяет время изменения файлов, при изменении вызывает Request;
+    // при выбранном профиле изменение только сообщается в журнал
+    bool PollFiles();
+
+    // Готовый снимок или nullptr; владение переходит вызывающему
+    DriverConfig* TakeReady();
+
+    const ReloadStats& Stats() const;
+
+private:
+    void Rebuild();
+    void RebuildOnce();
+    DriverConfig* Build(const Message::Init& settings, const Message::GamepadBindings& bindings);
+    bool ReadModificationTimes(time_t* times) const;
+
+    ipc::Core& core;
+    Executor executor;
+    ipc::Loader<Message::Init> init;
+    ipc::Loader<Message::GamepadBindings> gamepadBindings;
+
+    // Исходные сообщения для сборки: requested пишет основной поток, building - копия потока сборки
+    struct Source
+    {
+        Message::Init settings;
+        Message::GamepadBindings bindings;
+        std::string profile;
+    };
+    Source requested;
+    Source building;
+    std::mutex requestedLock;
+
+    std::string files[2];
+    time_t modified[2] = {};
+
+    std::thread worker;
+    std::atomic<bool> busy;
+    std::atomic<bool> again;
+    std::atomic<const Profile*> profile;
+    std::atomic<DriverConfig*> ready;
+    std::atomic<uint32_t> activeChecksum;
+    std::atomic<int> unchanged;
+
+    std::chrono::steady_clock::time_point requestTime;
+    uint32_t nextVersion = 1;
+    ReloadStats stats;
+};
@@ -0,0 +1,110 @@
+#include "controlbundle.h"
+
+void ControlBundler::Configure(int size)
+{
+    this->size = size < 1 ? 1 : (size > ControlBundleCapacity ? ControlBundleCapacity : size);
+}
+
+void ControlBundler::Reset()
+{
+    count = 0;
+}
+
+bool ControlBundler::Fits(const motion::Control& control) const
+{
+    if (count == 0) {
+        return true;
+    }
+    if (count >= size || control.time_limit != timeLimit || control.priority != priority
+            || control.is_compensation != isCompensation) {
+        return false;
+    }
+    for (int i = 0; i < geo::Num; i++) {
+        if (control.parameters[i].type != type[i] || control.parameters[i].frame != frame[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void ControlBundler::Add(const motion::Control& control, uint64_t timestamp)
+{
+    if (count == 0) {
+        timeLimit = control.time_limit;
+        priority = control.priority;
+        isCompensation = control.is_compensation;
+        for (int i = 0; i < geo::Num; i++) {
+            type[i] = control.parameters[i].type;
+            frame[i] = control.parameters[i].frame;
+        }
+    }
+    Message::ControlSample& sample = samples[count++];
+    sample.timestamp = timestamp;
+    for (int i = 0; i < geo::Num; i++) {
+        sample.value[i] = static_cast<float>(control.parameters[i].value);
+    }
+}
+
+bool ControlBundler::IsFull() const
+{
+    return count >= size;
+}
+
+int ControlBundler::Count() const
+{
+    return count;
+}
+
+void ControlBundler::Flush(Message::ControlBundle& bundle)
+{
+    bundle.sequence = ++sequence;
+    bundle.count = count;
+    bundle.time_limit = timeLimit;
+    bundle.priority = priority;
+    bundle.is_compensation = isCompensation;
+    for (int i = 0; i < geo::Num; i++) {
+        bundle.type[i] = type[i];
+        bundle.frame[i] = frame[i];
+    }
+    for (int i = 0; i < count; i++) {
+        bundle.samples[i] = samples[i];
+    }
+    count = 0;
+}
+
+void ControlUnbundler::Reset()
+{
+    started = false;
+    sequenced = false;
+    lastTimestamp = 0;
+    lastSequence = 0;
+    lost = 0;
+}
+
+// Заголовок пакета переносится в управление; повтор и опоздавший пакет отбрасываются,
+// пропуск номеров считается потерей
+bool ControlUnbundler::Accept(const Message::ControlBundle& bundle)
+{
+    if (sequenced && bundle.sequence <= lastSequence) {
+        return false;
+    }
+    if (sequenced && bundle.sequence > lastSequence + 1) {
+        lost += bundle.sequence - lastSequence - 1;
+    }
+    sequenced = true;
+    lastSequence = bundle.sequence;
+
+    control.time_limit = bundle.time_limit;
+    control.priority = motion::Priority::Enum(bundle.priority);
+    control.is_compensation = bundle.is_compensation;
+    for (int i = 0; i < geo::Num; i++) {
+        control.parameters[i].type = motion::ControlType::Enum(bundle.type[i]);
+        control.parameters[i].frame = scene::Object(bundle.frame[i]);
+    }
+    return true;
+}
+
+uint32_t ControlUnbundler::LostBundles() const
+{
+    return lost;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+
+#include "messages.h"
+#include "motion.h"
+
+const int ControlBundleCapacity = 32;   // Message::ControlBundle::samples
+
+// Накопитель отсчетов высокой частоты для Message::ControlBundle.
+// Буфер выделен заранее; пакет уходит, когда набрано bundle_size отсчетов
+// или когда меняется заголовок: типы, системы координат, приоритет, компенсация.
+class ControlBundler
+{
+public:
+    void Configure(int size);
+    void Reset();
+
+    // Отсчет можно добавить в текущий пакет: есть место и совпадают типы и системы
+    bool Fits(const motion::Control& control) const;
+    void Add(const motion::Control& control, uint64_t timestamp);
+    bool IsFull() const;
+    int Count() const;
+
+    // Переносит отсчеты в сообщение с очередным номером и очищает буфер
+    void Flush(Message::ControlBundle& bundle);
+
+private:
+    Message::ControlSample samples[ControlBundleCapacity];
+    int type[geo::Num];
+    int frame[geo::Num];
+    double timeLimit = 0;
+    motion::Priority::Enum priority = motion::Priority::NoControl;
+    bool isCompensation = false;
+    int count = 0;
+    int size = 1;
+    uint32_t sequence = 0;
+};
+
+// Эталонный разбор пакета на стороне получателя: выдает по порядку отсчеты
+// новее уже выданных, так что повторы и перекрытия пакетов безопасны
+class ControlUnbundler
+{
+public:
+    void Reset();
+
+    // sink(const motion::Control&, uint64_t timestamp); возвращает число выданных отсчетов
+    template <typename Sink>
+    int Unpack(const Message::ControlBundle& bundle, Sink sink);
+
+    uint32_t LostBundles() const;
+
+private:
+    bool Accept(const Message::ControlBundle& bundle);
+
+    motion::Control control;
+    uint64_t lastTimestamp = 0;
+    uint32_t lastSequence = 0;
+    bool started = false;
+    bool sequenced = false;
+    uint32_t lost = 0;
+};
+
+template <typename Sink>
+int ControlUnbundler::Unpack(const Message::ControlBundle& bundle, Sink sink)
+{
+    if (!Accept(bundle)) {
+        return 0;
+    }
+    int emitted = 0;
+    for (int i = 0; i < bundle.count && i < ControlBundleCapacity; i++) {
+        const Message::ControlSample& sample = bundle.samples[i];
+        if (started && sample.timestamp <= lastTimestamp) {
+            continue;
+        }
+        for (int j = 0; j < geo::Num; j++) {
+            control.parameters[j].value = sample.value[j];
+        }
+        lastTimestamp = sample.timestamp;
+        started = true;
+        sink(static_cast<const motion::Control&>(control), sample.timestamp);
+        emitted++;
+    }
+    return emitted;
+}
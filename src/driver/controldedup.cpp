@@ -0,0 +1,45 @@
+#include "controldedup.h"
+
+void ControlDedup::Reset()
+{
+    *this = ControlDedup();
+}
+
+bool ControlDedup::Accept(Path path, uint32_t sequence, uint64_t timestamp)
+{
+    paths[path].Receive(sequence, timestamp);
+    uint32_t restarts = merged.Restarts();
+    if (!merged.Receive(sequence, timestamp)) {
+        return false;
+    }
+    // Перезапуск отправителя начинает номера заново
+    bool restarted = merged.Restarts() != restarts;
+    if (forwarded && !restarted && static_cast<int32_t>(sequence - forwardedHighest) <= 0) {
+        late++;
+        return false;
+    }
+    forwarded = true;
+    forwardedHighest = sequence;
+    wins[path]++;
+    return true;
+}
+
+const SequenceTracker& ControlDedup::Merged() const
+{
+    return merged;
+}
+
+const SequenceTracker& ControlDedup::Arrived(Path path) const
+{
+    return paths[path];
+}
+
+uint32_t ControlDedup::Wins(Path path) const
+{
+    return wins[path];
+}
+
+uint32_t ControlDedup::Late() const
+{
+    return late;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+
+#include "sequencetracker.h"
+
+// Сведение команд, пришедших двумя независимыми путями: потребителю уходит
+// только первая копия номера новее уже переданных. Копия, опоздавшая за
+// более позднюю команду другого пути, учитывается как перестановка, но не
+// передается: старая команда поверх новой дала бы рывок. Потери после
+// сведения - это команды, не дошедшие ни одним путем.
+class ControlDedup
+{
+public:
+    enum Path { Bus, Udp, PathCount };
+
+    void Reset();
+
+    // true - первая копия номера новее переданных, передать потребителю
+    bool Accept(Path path, uint32_t sequence, uint64_t timestamp);
+
+    const SequenceTracker& Merged() const;
+    const SequenceTracker& Arrived(Path path) const;
+
+    // Сколько раз путь доставил команду первым
+    uint32_t Wins(Path path) const;
+    // Первые копии, опоздавшие за более позднюю команду и не переданные
+    uint32_t Late() const;
+
+private:
+    SequenceTracker merged;
+    SequenceTracker paths[PathCount];
+    uint32_t wins[PathCount] = {};
+    bool forwarded = false;
+    uint32_t forwardedHighest = 0;
+    uint32_t late = 0;
+};
@@ -0,0 +1,110 @@
+#include "controlframe.h"
+
+#include <cstring>
+
+static void Put16(uint8_t*& p, uint16_t value)
+{
+    p[0] = static_cast<uint8_t>(value);
+    p[1] = static_cast<uint8_t>(value >> 8);
+    p += 2;
+}
+
+static void Put32(uint8_t*& p, uint32_t value)
+{
+    Put16(p, static_cast<uint16_t>(value));
+    Put16(p, static_cast<uint16_t>(value >> 16));
+}
+
+static void Put64(uint8_t*& p, uint64_t value)
+{
+    Put32(p, static_cast<uint32_t>(value));
+    Put32(p, static_cast<uint32_t>(value >> 32));
+}
+
+static void PutFloat(uint8_t*& p, float value)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    Put32(p, bits);
+}
+
+static uint16_t Get16(const uint8_t*& p)
+{
+    uint16_t value = static_cast<uint16_t>(p[0] | (p[1] << 8));
+    p += 2;
+    return value;
+}
+
+static uint32_t Get32(const uint8_t*& p)
+{
+    uint32_t low = Get16(p);
+    return low | (static_cast<uint32_t>(Get16(p)) << 16);
+}
+
+static uint64_t Get64(const uint8_t*& p)
+{
+    uint64_t low = Get32(p);
+    return low | (static_cast<uint64_t>(Get32(p)) << 32);
+}
+
+static float GetFloat(const uint8_t*& p)
+{
+    uint32_t bits = Get32(p);
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+void EncodeControlFrame(const motion::Control& control, const ControlFrameHeader& header, uint8_t* out)
+{
+    uint8_t* p = out;
+    *p++ = ControlFrameMagic0;
+    *p++ = ControlFrameMagic1;
+    *p++ = ControlFrameVersion;
+    *p++ = control.is_compensation ? ControlFrameCompensation : 0;
+    Put32(p, header.sequence);
+    Put64(p, header.timestamp);
+    PutFloat(p, static_cast<float>(control.time_limit));
+    Put16(p, static_cast<uint16_t>(static_cast<int16_t>(control.priority)));
+    Put16(p, 0);
+    for (int i = 0; i < geo::Num; i++) {
+        const motion::ControlParameter& parameter = control.parameters[i];
+        *p++ = static_cast<uint8_t>(static_cast<int8_t>(parameter.type));
+        Put16(p, static_cast<uint16_t>(static_cast<int16_t>(parameter.frame)));
+        PutFloat(p, static_cast<float>(parameter.value));
+    }
+}
+
+bool DecodeControlFrame(const uint8_t* data, size_t size, motion::Control& control, ControlFrameHeader& header)
+{
+    if (size != ControlFrameSize || data[0] != ControlFrameMagic0 || data[1] != ControlFrameMagic1
+            || data[2] != ControlFrameVersion) {
+        return false;
+    }
+    const uint8_t* p = data + 3;
+    uint8_t flags = *p++;
+    header.sequence = Get32(p);
+    header.timestamp = Get64(p);
+    control.time_limit = GetFloat(p);
+    control.priority = motion::Priority::Enum(static_cast<int16_t>(Get16(p)));
+    control.is_compensation = (flags & ControlFrameCompensation) != 0;
+    p += 2;
+    for (int i = 0; i < geo::Num; i++) {
+        motion::ControlParameter& parameter = control.parameters[i];
+        parameter.type = motion::ControlType::Enum(static_cast<int8_t>(*p++));
+        parameter.frame = scene::Object(static_cast<int16_t>(Get16(p)));
+        parameter.value = GetFloat(p);
+    }
+    return true;
+}
+
+uint32_t ControlChecksum(const motion::Control& control)
+{
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&control);
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < sizeof(control); i++) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "messages.h"
+#include "motion.h"
+
+// Двоичный кадр motion::Control для прямой отправки по UDP мимо шины.
+// Поля пишутся побайтно в little-endian, кадр не зависит от выравнивания и
+// компилятора. Получатель принимает только свою версию и точный размер.
+//
+//   0  магия 'J','C'       8  время отправки, мкс    24  по степеням свободы:
+//   2  версия              16 time_limit, float          тип (1), СК (2), значение (float)
+//   3  флаги               20 приоритет (int16)
+//   4  номер команды       22 резерв (2)
+const uint8_t ControlFrameMagic0 = 'J';
+const uint8_t ControlFrameMagic1 = 'C';
+const uint8_t ControlFrameVersion = 1;
+const size_t ControlFrameSize = 24 + 7 * geo::Num;
+
+// Флаги кадра
+const uint8_t ControlFrameCompensation = 0x01;
+
+struct ControlFrameHeader
+{
+    uint32_t sequence = 0;
+    uint64_t timestamp = 0;
+};
+
+// Пишет ControlFrameSize байт в out
+void EncodeControlFrame(const motion::Control& control, const ControlFrameHeader& header, uint8_t* out);
+
+// false - не кадр, чужая версия или неверный размер; control и header не тронуты
+bool DecodeControlFrame(const uint8_t* data, size_t size, motion::Control& control, ControlFrameHeader& header);
+
+// FNV-1a по байтам упакованной команды: Message::ControlStamp сверяется с
+// motion::Control, пришедшим по шине, чтобы метка не досталась чужой команде
+uint32_t ControlChecksum(const motion::Control& control);
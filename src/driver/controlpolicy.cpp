@@ -0,0 +1,55 @@
+#include "controlpolicy.h"
+
+#include <cmath>
+
+void ControlSendPolicy::Configure(const ControlPolicySettings& settings)
+{
+    this->settings = settings;
+}
+
+void ControlSendPolicy::Reset()
+{
+    hasLast = false;
+}
+
+bool ControlSendPolicy::Accept(const motion::Control& control, uint32_t now)
+{
+    if (settings.enabled && hasLast && Matches(control) && now - lastTime < settings.keepalive) {
+        return false;
+    }
+    last = control;
+    hasLast = true;
+    lastTime = now;
+    return true;
+}
+
+bool ControlSendPolicy::IsNeutralPending() const
+{
+    return hasLast && !IsNeutral(last);
+}
+
+bool ControlSendPolicy::Matches(const motion::Control& control) const
+{
+    if (control.priority != last.priority || control.is_compensation != last.is_compensation
+            || control.time_limit != last.time_limit) {
+        return false;
+    }
+    for (int i = 0; i < geo::Num; i++) {
+        const motion::ControlParameter& a = control.parameters[i];
+        const motion::ControlParameter& b = last.parameters[i];
+        if (a.type != b.type || a.frame != b.frame || std::fabs(a.value - b.value) > settings.tolerance) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ControlSendPolicy::IsNeutral(const motion::Control& control)
+{
+    for (int i = 0; i < geo::Num; i++) {
+        if (control.parameters[i].value != 0.0) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+
+#include "motion.h"
+
+struct ControlPolicySettings
+{
+    bool     enabled = true;
+    double   tolerance = 0.01;      // Допуск на значение степени свободы
+    uint32_t keepalive = 1500;      // Повтор неизменной команды, мс; меньше time_limit аппарата
+};
+
+// Решает, уходит ли очередной motion::Control на шину. Команда, совпадающая с
+// последней отправленной в пределах допуска, пропускается, пока не подойдет
+// время повтора. Когда ввод затихает после ненулевой команды, нулевая
+// отправляется сразу, не дожидаясь истечения time_limit на аппарате.
+class ControlSendPolicy
+{
+public:
+    void Configure(const ControlPolicySettings& settings);
+
+    // Забыть последнюю отправленную: следующая команда уйдет в любом случае
+    void Reset();
+
+    // true - команду отправить; она запоминается как последняя
+    bool Accept(const motion::Control& control, uint32_t now);
+
+    // Последняя отправленная команда ненулевая, при затихании ввода нужна нулевая
+    bool IsNeutralPending() const;
+
+    static bool IsNeutral(const motion::Control& control);
+
+private:
+    bool Matches(const motion::Control& control) const;
+
+    ControlPolicySettings settings;
+    motion::Control last;
+    bool hasLast = false;
+    uint32_t lastTime = 0;
+};
@@ -0,0 +1,82 @@
+#include "criticaldelivery.h"
+
+void CriticalDelivery::Configure(const CriticalSettings& settings)
+{
+    this->settings = settings;
+}
+
+void CriticalDelivery::Start(uint32_t sequence, uint32_t now)
+{
+    this->sequence = sequence;
+    result = Result::Pending;
+    started = now;
+    lastSent = now;
+    ackTime = 0;
+    retries = 0;
+    burstDue = true;
+}
+
+int CriticalDelivery::Due(uint32_t now)
+{
+    if (result != Result::Pending) {
+        return 0;
+    }
+    if (burstDue) {
+        burstDue = false;
+        lastSent = now;
+        return settings.burst > 0 ? settings.burst : 1;
+    }
+    if (now - lastSent < settings.retry) {
+        return 0;
+    }
+    if (retries >= settings.retries) {
+        result = Result::Failed;
+        return 0;
+    }
+    retries++;
+    lastSent = now;
+    return 1;
+}
+
+bool CriticalDelivery::Acknowledge(uint32_t sequence, uint32_t now)
+{
+    // Разность по модулю 2^32: подтверждение более поздней команды покрывает и эту
+    if (result != Result::Pending || static_cast<int32_t>(sequence - this->sequence) < 0) {
+        return false;
+    }
+    result = Result::Acknowledged;
+    ackTime = now - started;
+    return true;
+}
+
+void CriticalDelivery::Supersede()
+{
+    if (result == Result::Pending) {
+        result = Result::Superseded;
+    }
+}
+
+bool CriticalDelivery::IsPending() const
+{
+    return result == Result::Pending;
+}
+
+CriticalDelivery::Result CriticalDelivery::LastResult() const
+{
+    return result;
+}
+
+uint32_t CriticalDelivery::Sequence() const
+{
+    return sequence;
+}
+
+int CriticalDelivery::Retries() const
+{
+    return retries;
+}
+
+uint32_t CriticalDelivery::AckTime() const
+{
+    return ackTime;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+
+struct CriticalSettings
+{
+    int      burst = 3;             // Копий сразу при отправке
+    uint32_t retry = 50;            // Повтор без подтверждения, мс
+    int      retries = 20;          // Повторов до отказа
+};
+
+// Доставка команды остановки с подтверждением. Команда уходит пачкой копий
+// с одним номером и повторяется, пока получатель не подтвердит этот номер или
+// более поздний. Новая обычная команда отменяет ожидание: повтор устаревшей
+// остановки поверх нее был бы ошибкой.
+class CriticalDelivery
+{
+public:
+    enum class Result { Pending, Acknowledged, Superseded, Failed };
+
+    void Configure(const CriticalSettings& settings);
+
+    void Start(uint32_t sequence, uint32_t now);
+
+    // Сколько копий отправить сейчас; 0 - ждать. Исчерпав повторы, ожидание кончается отказом
+    int Due(uint32_t now);
+
+    // true - подтвержден ожидаемый номер
+    bool Acknowledge(uint32_t sequence, uint32_t now);
+    void Supersede();
+
+    bool IsPending() const;
+    Result LastResult() const;
+    uint32_t Sequence() const;
+    int Retries() const;
+    uint32_t AckTime() const;       // От первой копии до подтверждения, мс
+
+private:
+    CriticalSettings settings;
+    Result result = Result::Acknowledged;
+    uint32_t sequence = 0;
+    uint32_t started = 0;
+    uint32_t lastSent = 0;
+    uint32_t ackTime = 0;
+    int retries = 0;
+    bool burstDue = false;
+};
@@ -1,5 +1,5 @@
 TEMPLATE = app
-CONFIG += console c++11
+CONFIG += console c++11 thread
 CONFIG -= app_bundle                 # Не собирать маковский архив
 CONFIG -= qt
 QT -= gui
@@ -10,27 +10,74 @@ MOC_DIR = $$PWD/build                # Путь моков
 RCC_DIR = $$PWD/build                # Путь ресорцов
 TARGET = driver
 
+# Детерминированное отображение осей независимо от настроек:
+# DEFINES += DRIVER_FIXED_POINT
+
+# Неизменные привязки из flightbindings.h вместо Message--GamepadBindings.json:
+# DEFINES += DRIVER_STATIC_BINDINGS
+
 INSTALL.path = $$DESTDIR             # Куда копируем
 
 SOURCES += \
-    command.cpp \
+    axisaccumulator.cpp \
+    commanddispatch.cpp \
     commands.cpp \
     commandshandler.cpp \
+    configreloader.cpp \
+    controlbundle.cpp \
+    controlframe.cpp \
+    controlpolicy.cpp \
+    criticaldelivery.cpp \
+    driverconfig.cpp \
+    expression.cpp \
+    fixedmapping.cpp \
     gamepad.cpp \
+    latencyhistogram.cpp \
+    linkadapter.cpp \
+    looplatency.cpp \
+    macro.cpp \
     main.cpp \
+    mapping.cpp \
+    noiseestimator.cpp \
+    predictor.cpp \
+    profilestore.cpp \
     application.cpp \
-    sender.cpp
+    sender.cpp \
+    sendstats.cpp \
+    speedgears.cpp
 
 
 HEADERS += \
-    command.h \
+    axisaccumulator.h \
+    commanddispatch.h \
     commands.h \
     commandshandler.h \
+    configreloader.h \
+    controlbundle.h \
+    controlframe.h \
+    controlpolicy.h \
+    criticaldelivery.h \
+    driverconfig.h \
+    expression.h \
+    fixedmapping.h \
+    flightbindings.h \
     messages.h \
     application.h \
     gamepad.h \
+    latencyhistogram.h \
+    linkadapter.h \
+    looplatency.h \
+    macro.h \
+    mapping.h \
+    monotonic.h \
     motion.h \
-    sender.h
+    noiseestimator.h \
+    predictor.h \
+    profilestore.h \
+    sender.h \
+    sendstats.h \
+    speedgears.h \
+    staticbindings.h
 
 
 win32 {
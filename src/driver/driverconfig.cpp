@@ -0,0 +1,107 @@
+#include "driverconfig.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <new>
+
+#include "flightbindings.h"
+
+static const size_t ConfigAlignment = 32;
+
+void* DriverConfig::operator new(size_t size)
+{
+    // Перед выровненным блоком храним исходный указатель для delete
+    void* raw = malloc(size + ConfigAlignment + sizeof(void*));
+    if (raw == nullptr) {
+        throw std::bad_alloc();
+    }
+    uintptr_t start = reinterpret_cast<uintptr_t>(raw) + sizeof(void*);
+    uintptr_t aligned = (start + ConfigAlignment - 1) & ~(ConfigAlignment - 1);
+    reinterpret_cast<void**>(aligned)[-1] = raw;
+    return reinterpret_cast<void*>(aligned);
+}
+
+void DriverConfig::operator delete(void* pointer)
+{
+    if (pointer != nullptr) {
+        free(static_cast<void**>(pointer)[-1]);
+    }
+}
+
+// FNV-1a по байтам упакованных сообщений
+static uint32_t Fnv1a(uint32_t hash, const void* data, size_t size)
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+uint32_t DriverConfigChecksum(const Message::Init& settings, const Message::GamepadBindings& bindings)
+{
+    uint32_t hash = 2166136261u;
+    hash = Fnv1a(hash, &settings, sizeof(settings));
+    hash = Fnv1a(hash, &bindings, sizeof(bindings));
+    return hash;
+}
+
+DriverConfig* BuildDriverConfig(const Message::Init& settings, const Message::GamepadBindings& bindings)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    DriverConfig* config = new DriverConfig();
+    CopyMessage(config->settings, settings);
+    CopyMessage(config->bindings, bindings);
+    config->checksum = DriverConfigChecksum(settings, bindings);
+
+#ifdef DRIVER_FIXED_POINT
+    config->useFixedPoint = true;
+#else
+    config->useFixedPoint = settings.fixed_point;
+#endif
+
+    config->deadzone.adaptive = settings.deadzone_adaptive;
+    config->deadzone.deadzone = settings.deadzone;
+    config->deadzone.minimum  = settings.deadzone_min;
+    config->deadzone.maximum  = settings.deadzone_max;
+    config->deadzone.sigmas   = settings.deadzone_sigmas;
+
+    config->predictor.enabled = settings.prediction;
+    config->predictor.latency = settings.prediction_latency;
+    config->predictor.alpha   = settings.prediction_alpha;
+    config->predictor.beta    = settings.prediction_beta;
+
+    const Message::SpeedGear* gears = settings.gears;
+    config->gears.count   = settings.gear_count;
+    config->gears.initial = settings.gear_initial - 1;
+    for (int i = 0; i < SpeedGearMax; i++) {
+        config->gears.gain[i][geo::Right]   = static_cast<float>(gears[i].right);
+        config->gears.gain[i][geo::Forward] = static_cast<float>(gears[i].forward);
+        config->gears.gain[i][geo::Up]      = static_cast<float>(gears[i].up);
+        config->gears.gain[i][geo::Yaw]     = static_cast<float>(gears[i].yaw);
+        config->gears.gain[i][geo::Pitch]   = static_cast<float>(gears[i].pitch);
+        config->gears.gain[i][geo::Roll]    = static_cast<float>(gears[i].roll);
+    }
+
+#ifdef DRIVER_STATIC_BINDINGS
+    config->layerCount = 1;
+    FlightBindings::BuildMapping(config->layers[0].mapping);
+    ClearFormulas(config->layers[0].formulas);
+#else
+    config->layerCount = LayerCount(bindings);
+    for (int i = 0; i < config->layerCount; i++) {
+        BindingLayer& layer = config->layers[i];
+        layer.commands.Compile(bindings, i);
+        layer.commands.Table().BuildMapping(layer.mapping);
+        layer.commands.Table().BuildFormulas(layer.formulas);
+    }
+#endif
+    for (int i = 0; i < config->layerCount; i++) {
+        CompileFixedMapping(config->layers[i].mapping, config->layers[i].fixedMapping);
+    }
+
+    config->buildTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return config;
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include "commandshandler.h"
+#include "fixedmapping.h"
+#include "mapping.h"
+#include "messages.h"
+#include "noiseestimator.h"
+#include "predictor.h"
+#include "speedgears.h"
+
+// Слой привязок, собранный заранее: переключение слоя - смена индекса
+struct BindingLayer
+{
+    CommandsHandler commands;
+    MappingTable mapping;
+    FixedMappingTable fixedMapping;
+    FormulaTable formulas;
+};
+
+// Неизменяемый снимок настроек: все таблицы, которые читает такт управления.
+// Собирается целиком вне такта и подменяется одним указателем, поэтому такт
+// никогда не видит наполовину обновленную конфигурацию.
+struct DriverConfig
+{
+    uint32_t version = 0;
+    uint32_t checksum = 0;
+    double buildTime = 0;       // Время сборки, с
+    std::string profile;        // Пусто - настройки из файлов load
+
+    Message::Init settings;
+    Message::GamepadBindings bindings;
+
+    bool useFixedPoint = false;
+    DeadzoneSettings deadzone;
+    PredictorSettings predictor;
+    SpeedGearTable gears;
+
+    int layerCount = 1;
+    BindingLayer layers[LayerMax];
+
+    // Таблицы отображения выровнены под AVX, обычный new этого не гарантирует до C++17
+    static void* operator new(size_t size);
+    static void operator delete(void* pointer);
+};
+
+// Копия упакованного сообщения байт в байт, как его передает шина и хранит кэш профилей.
+// Присваивание целиком шло бы через неявную копию ipc::String (-Wdeprecated-copy)
+template <typename T>
+void CopyMessage(T& to, const T& from)
+{
+    std::memcpy(static_cast<void*>(&to), static_cast<const void*>(&from), sizeof(T));
+}
+
+uint32_t DriverConfigChecksum(const Message::Init& settings, const Message::GamepadBindings& bindings);
+
+// Собирает снимок из сообщений настроек, к ядру IPC не обращается
+DriverConfig* BuildDriverConfig(const Message::Init& settings, const Message::GamepadBindings& bindings);
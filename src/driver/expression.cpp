@@ -0,0 +1,536 @@
+#include "expression.h"
+
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#include "SDL2/SDL.h"
+#undef main
+
+// Число операндов и стоимость каждой команды
+static const uint8_t OperandCount[ExpressionOp::Num] = {
+    0, 0, 0, 0,         // Constant, Input, Button, Gear
+    1, 1, 1, 1,         // Negate, Not, Abs, Sign
+    2, 2, 2, 2,         // Add, Subtract, Multiply, Divide
+    2, 2, 2, 2, 2, 2,   // сравнения
+    2, 2, 2, 2, 2,      // And, Or, Min, Max, Expo
+    3, 3                // Select, Clamp
+};
+static const uint8_t OperationCost[ExpressionOp::Num] = {
+    1, 1, 1, 1,
+    1, 1, 1, 1,
+    1, 1, 1, 4,
+    1, 1, 1, 1, 1, 1,
+    1, 1, 1, 1, 3,
+    1, 2
+};
+
+namespace {
+
+// Разбор по убыванию приоритета: ?: || && сравнения + - * / унарные.
+// Каждое правило кладет результат в регистр dst и пользуется регистрами выше как временными.
+class ExpressionCompiler
+{
+public:
+    ExpressionCompiler(const char* text, Expression& expression)
+        : p(text)
+        , out(expression)
+    {}
+
+    bool Compile(std::string& error)
+    {
+        out.length = 0;
+        out.constantCount = 0;
+        out.registers = 0;
+        if (!Ternary(0)) {
+            error = message;
+            return false;
+        }
+        SkipSpaces();
+        if (*p != '\0') {
+            error = std::string("unexpected '") + *p + "'";
+            return false;
+        }
+        return true;
+    }
+
+private:
+    bool Ternary(int dst)
+    {
+        if (!Or(dst)) {
+            return false;
+        }
+        if (!Match("?")) {
+            return true;
+        }
+        if (!Ternary(dst + 1)) {
+            return false;
+        }
+        if (!Match(":")) {
+            return Fail("expected ':'");
+        }
+        return Ternary(dst + 2) && Emit(ExpressionOp::Select, dst, dst, dst + 1, dst + 2);
+    }
+
+    bool Or(int dst)
+    {
+        if (!And(dst)) {
+            return false;
+        }
+        while (Match("||")) {
+            if (!And(dst + 1) || !Emit(ExpressionOp::Or, dst, dst, dst + 1)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool And(int dst)
+    {
+        if (!Compare(dst)) {
+            return false;
+        }
+        while (Match("&&")) {
+            if (!Compare(dst + 1) || !Emit(ExpressionOp::And, dst, dst, dst + 1)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool Compare(int dst)
+    {
+        static const char* const tokens[] = {"<=", ">=", "==", "!=", "<", ">"};
+        static const ExpressionOp::Enum ops[] = {
+            ExpressionOp::LessEqual, ExpressionOp::GreaterEqual, ExpressionOp::Equal,
+            ExpressionOp::NotEqual, ExpressionOp::Less, ExpressionOp::Greater
+        };
+        if (!Additive(dst)) {
+            return false;
+        }
+        for (;;) {
+            int found = -1;
+            for (int i = 0; i < 6 && found < 0; i++) {
+                found = Match(tokens[i]) ? i : -1;
+            }
+            if (found < 0) {
+                return true;
+            }
+            if (!Additive(dst + 1) || !Emit(ops[found], dst, dst, dst + 1)) {
+                return false;
+            }
+        }
+    }
+
+    bool Additive(int dst)
+    {
+        if (!Multiplicative(dst)) {
+            return false;
+        }
+        for (;;) {
+            ExpressionOp::Enum op;
+            if (Match("+")) {
+                op = ExpressionOp::Add;
+            }
+            else if (Match("-")) {
+                op = ExpressionOp::Subtract;
+            }
+            else {
+                return true;
+            }
+            if (!Multiplicative(dst + 1) || !Emit(op, dst, dst, dst + 1)) {
+                return false;
+            }
+        }
+    }
+
+    bool Multiplicative(int dst)
+    {
+        if (!Unary(dst)) {
+            return false;
+        }
+        for (;;) {
+            ExpressionOp::Enum op;
+            if (Match("*")) {
+                op = ExpressionOp::Multiply;
+            }
+            else if (Match("/")) {
+                op = ExpressionOp::Divide;
+            }
+            else {
+                return true;
+            }
+            if (!Unary(dst + 1) || !Emit(op, dst, dst, dst + 1)) {
+                return false;
+            }
+        }
+    }
+
+    bool Unary(int dst)
+    {
+        if (Match("-")) {
+            return Unary(dst) && Emit(ExpressionOp::Negate, dst, dst);
+        }
+        if (Match("!")) {
+            return Unary(dst) && Emit(ExpressionOp::Not, dst, dst);
+        }
+        if (Match("+")) {
+            return Unary(dst);
+        }
+        return Primary(dst);
+    }
+
+    bool Primary(int dst)
+    {
+        SkipSpaces();
+        if (Match("(")) {
+            if (!Ternary(dst)) {
+                return false;
+            }
+            return Match(")") || Fail("expected ')'");
+        }
+        if (isdigit(static_cast<unsigned char>(*p)) || *p == '.') {
+            char* end;
+            double value = strtod(p, &end);
+            p = end;
+            return Constant(dst, static_cast<float>(value));
+        }
+        if (isalpha(static_cast<unsigned char>(*p)) || *p == '_') {
+            std::string name;
+            while (isalnum(static_cast<unsigned char>(*p)) || *p == '_') {
+                name += *p++;
+            }
+            if (Match("(")) {
+                return Call(dst, name);
+            }
+            return Name(dst, name);
+        }
+        if (*p == '\0') {
+            return Fail("unexpected end of expression");
+        }
+        return Fail(std::string("unexpected '") + *p + "'");
+    }
+
+    bool Call(int dst, const std::string& name)
+    {
+        ExpressionOp::Enum op;
+        if (name == "abs") {
+            op = ExpressionOp::Abs;
+        }
+        else if (name == "sign") {
+            op = ExpressionOp::Sign;
+        }
+        else if (name == "min") {
+            op = ExpressionOp::Min;
+        }
+        else if (name == "max") {
+            op = ExpressionOp::Max;
+        }
+        else if (name == "expo") {
+            op = ExpressionOp::Expo;
+        }
+        else if (name == "clamp") {
+            op = ExpressionOp::Clamp;
+        }
+        else {
+            return Fail("unknown function '" + name + "'");
+        }
+
+        int count = 0;
+        if (!Match(")")) {
+            do {
+                if (!Ternary(dst + count)) {
+                    return false;
+                }
+                count++;
+            } while (Match(","));
+            if (!Match(")")) {
+                return Fail("expected ')' after arguments of '" + name + "'");
+            }
+        }
+        if (count != OperandCount[op]) {
+            return Fail("wrong number of arguments for '" + name + "'");
+        }
+        return Emit(op, dst, dst, dst + 1, dst + 2);
+    }
+
+    bool Name(int dst, const std::string& name)
+    {
+        if (name == "gear") {
+            return Emit(ExpressionOp::Gear, dst);
+        }
+
+        std::string axisName = name;
+        AxisSample sample = AxisSample::Last;
+        size_t split = name.rfind('_');
+        if (split != std::string::npos) {
+            std::string suffix = name.substr(split + 1);
+            if (suffix == "last" || suffix == "mean" || suffix == "peak") {
+                sample = AxisSampleFromString(suffix.c_str());
+                axisName = name.substr(0, split);
+            }
+        }
+        SDL_GameControllerAxis axis = SDL_GameControllerGetAxisFromString(axisName.c_str());
+        if (axis != SDL_CONTROLLER_AXIS_INVALID) {
+            return Emit(ExpressionOp::Input, dst, MappingSourceIndex(axis, sample));
+        }
+        SDL_GameControllerButton button = SDL_GameControllerGetButtonFromString(name.c_str());
+        if (button != SDL_CONTROLLER_BUTTON_INVALID) {
+            return Emit(ExpressionOp::Button, dst, button);
+        }
+        return Fail("unknown name '" + name + "'");
+    }
+
+    bool Constant(int dst, float value)
+    {
+        int index = 0;
+        while (index < out.constantCount && out.constants[index] != value) {
+            index++;
+        }
+        if (index == out.constantCount) {
+            if (out.constantCount == ExpressionConstantMax) {
+                return Fail("too many constants");
+            }
+            out.constants[out.constantCount++] = value;
+        }
+        return Emit(ExpressionOp::Constant, dst, index);
+    }
+
+    bool Emit(ExpressionOp::Enum op, int dst, int a = 0, int b = 0, int c = 0)
+    {
+        if (out.length == ExpressionCodeMax) {
+            return Fail("expression is too long");
+        }
+        // Операнды-регистры лежат не выше dst + 2, поэтому хватает проверки самого верхнего
+        int top = dst + OperandCount[op];
+        if (top > ExpressionRegisterMax || dst >= ExpressionRegisterMax) {
+            return Fail("expression is nested too deeply");
+        }
+        if (dst + 1 > out.registers) {
+            out.registers = static_cast<uint8_t>(dst + 1);
+        }
+        ExpressionInstruction& instruction = out.code[out.length++];
+        instruction.op = op;
+        instruction.dst = static_cast<uint8_t>(dst);
+        instruction.a = static_cast<uint8_t>(a);
+        instruction.b = static_cast<uint8_t>(b);
+        instruction.c = static_cast<uint8_t>(c);
+        return Fold();
+    }
+
+    // Команда над одними константами, только что загруженными подряд, заменяется ее результатом:
+    // "-5", "2 * 3" и "min(1, 2)" стоят одной загрузки
+    bool Fold()
+    {
+        const ExpressionInstruction last = out.code[out.length - 1];
+        int count = OperandCount[last.op];
+        if (count == 0 || out.length < count + 1) {
+            return true;
+        }
+        for (int i = 0; i < count; i++) {
+            const ExpressionInstruction& load = out.code[out.length - 1 - count + i];
+            if (load.op != ExpressionOp::Constant || load.dst != last.dst + i) {
+                return true;
+            }
+        }
+
+        Expression tail;
+        tail.length = static_cast<uint8_t>(count + 1);
+        tail.constantCount = out.constantCount;
+        tail.registers = out.registers;
+        for (int i = 0; i < out.constantCount; i++) {
+            tail.constants[i] = out.constants[i];
+        }
+        for (int i = 0; i <= count; i++) {
+            ExpressionInstruction instruction = out.code[out.length - 1 - count + i];
+            // В хвосте результат должен попасть в нулевой регистр
+            instruction.dst = static_cast<uint8_t>(instruction.dst - last.dst);
+            instruction.a = instruction.op == ExpressionOp::Constant ? instruction.a
+                                                                     : static_cast<uint8_t>(instruction.a - last.dst);
+            instruction.b = static_cast<uint8_t>(instruction.b - last.dst);
+            instruction.c = static_cast<uint8_t>(instruction.c - last.dst);
+            tail.code[i] = instruction;
+        }
+        ExpressionInputs none = {nullptr, nullptr, 0};
+        float value = EvaluateExpression(tail, none, 0);
+
+        out.length = static_cast<uint8_t>(out.length - count - 1);
+        return Constant(last.dst, value);
+    }
+
+    void SkipSpaces()
+    {
+        while (isspace(static_cast<unsigned char>(*p))) {
+            p++;
+        }
+    }
+
+    bool Match(const char* token)
+    {
+        SkipSpaces();
+        size_t length = strlen(token);
+        if (strncmp(p, token, length) != 0) {
+            return false;
+        }
+        // "<" не должен съесть начало "<=", "!" - начало "!="
+        if (length == 1 && (token[0] == '<' || token[0] == '>' || token[0] == '!') && p[1] == '=') {
+            return false;
+        }
+        p += length;
+        return true;
+    }
+
+    bool Fail(const std::string& text)
+    {
+        if (message.empty()) {
+            message = text;
+        }
+        return false;
+    }
+
+    const char* p;
+    Expression& out;
+    std::string message;
+};
+
+}
+
+bool CompileExpression(const char* text, Expression& expression, std::string& error)
+{
+    ExpressionCompiler compiler(text, expression);
+    return compiler.Compile(error) && ValidateExpression(expression, error);
+}
+
+int ExpressionCost(const Expression& expression)
+{
+    int cost = 0;
+    for (int i = 0; i < expression.length; i++) {
+        cost += expression.code[i].op < ExpressionOp::Num ? OperationCost[expression.code[i].op] : 0;
+    }
+    return cost;
+}
+
+bool ValidateExpression(const Expression& expression, std::string& error)
+{
+    if (expression.length == 0 || expression.length > ExpressionCodeMax) {
+        error = "empty or too long program";
+        return false;
+    }
+    if (expression.registers > ExpressionRegisterMax || expression.constantCount > ExpressionConstantMax) {
+        error = "register or constant table overflow";
+        return false;
+    }
+
+    unsigned written = 0;
+    for (int i = 0; i < expression.length; i++) {
+        const ExpressionInstruction& instruction = expression.code[i];
+        if (instruction.op >= ExpressionOp::Num) {
+            error = "unknown instruction";
+            return false;
+        }
+        if (instruction.dst >= expression.registers) {
+            error = "register out of range";
+            return false;
+        }
+        const uint8_t operands[3] = {instruction.a, instruction.b, instruction.c};
+        for (int j = 0; j < OperandCount[instruction.op]; j++) {
+            if (operands[j] >= expression.registers || !((written >> operands[j]) & 1u)) {
+                error = "read of an unwritten register";
+                return false;
+            }
+        }
+        bool inRange = true;
+        switch (instruction.op) {
+            case ExpressionOp::Constant:
+                inRange = instruction.a < expression.constantCount;
+                break;
+            case ExpressionOp::Input:
+                inRange = instruction.a < MappingInputCount;
+                break;
+            case ExpressionOp::Button:
+                inRange = instruction.a < 32;
+                break;
+            default:
+                break;
+        }
+        if (!inRange) {
+            error = "operand out of range";
+            return false;
+        }
+        written |= 1u << instruction.dst;
+    }
+    if (!(written & 1u)) {
+        error = "no result";
+        return false;
+    }
+
+    int cost = ExpressionCost(expression);
+    if (cost > ExpressionCostMax) {
+        error = "cost " + std::to_string(cost) + " exceeds " + std::to_string(ExpressionCostMax);
+        return false;
+    }
+    return true;
+}
+
+float EvaluateExpression(const Expression& expression, const ExpressionInputs& inputs, int slot)
+{
+    float r[ExpressionRegisterMax];
+    for (int i = 0; i < expression.length; i++) {
+        const ExpressionInstruction& in = expression.code[i];
+        // Операнды читаются внутри ветвей: у загрузок поле a - индекс таблицы, а не регистр
+        float y;
+        switch (in.op) {
+            case ExpressionOp::Constant:     y = expression.constants[in.a]; break;
+            case ExpressionOp::Input:        y = inputs.input[in.a]; break;
+            case ExpressionOp::Button:       y = (inputs.buttons >> in.a) & 1u ? 1.0f : 0.0f; break;
+            case ExpressionOp::Gear:         y = inputs.scale[slot]; break;
+            case ExpressionOp::Negate:       y = -r[in.a]; break;
+            case ExpressionOp::Not:          y = r[in.a] == 0.0f ? 1.0f : 0.0f; break;
+            case ExpressionOp::Abs:          y = std::fabs(r[in.a]); break;
+            case ExpressionOp::Sign:         y = r[in.a] > 0.0f ? 1.0f : (r[in.a] < 0.0f ? -1.0f : 0.0f); break;
+            case ExpressionOp::Add:          y = r[in.a] + r[in.b]; break;
+            case ExpressionOp::Subtract:     y = r[in.a] - r[in.b]; break;
+            case ExpressionOp::Multiply:     y = r[in.a] * r[in.b]; break;
+            case ExpressionOp::Divide:       y = r[in.b] != 0.0f ? r[in.a] / r[in.b] : 0.0f; break;
+            case ExpressionOp::Less:         y = r[in.a] < r[in.b] ? 1.0f : 0.0f; break;
+            case ExpressionOp::LessEqual:    y = r[in.a] <= r[in.b] ? 1.0f : 0.0f; break;
+            case ExpressionOp::Greater:      y = r[in.a] > r[in.b] ? 1.0f : 0.0f; break;
+            case ExpressionOp::GreaterEqual: y = r[in.a] >= r[in.b] ? 1.0f : 0.0f; break;
+            case ExpressionOp::Equal:        y = r[in.a] == r[in.b] ? 1.0f : 0.0f; break;
+            case ExpressionOp::NotEqual:     y = r[in.a] != r[in.b] ? 1.0f : 0.0f; break;
+            case ExpressionOp::And:          y = r[in.a] != 0.0f && r[in.b] != 0.0f ? 1.0f : 0.0f; break;
+            case ExpressionOp::Or:           y = r[in.a] != 0.0f || r[in.b] != 0.0f ? 1.0f : 0.0f; break;
+            case ExpressionOp::Min:          y = r[in.a] < r[in.b] ? r[in.a] : r[in.b]; break;
+            case ExpressionOp::Max:          y = r[in.a] > r[in.b] ? r[in.a] : r[in.b]; break;
+            case ExpressionOp::Expo:         y = r[in.a] * (1.0f - r[in.b]) + r[in.b] * r[in.a] * r[in.a] * r[in.a]; break;
+            case ExpressionOp::Select:       y = r[in.a] != 0.0f ? r[in.b] : r[in.c]; break;
+            case ExpressionOp::Clamp:        y = r[in.a] < r[in.b] ? r[in.b] : (r[in.a] > r[in.c] ? r[in.c] : r[in.a]); break;
+            default:                         y = 0.0f; break;
+        }
+        r[in.dst] = y;
+    }
+    return r[0];
+}
+
+void ClearFormulas(FormulaTable& table)
+{
+    table.mask = 0;
+    for (auto& formula : table.formula) {
+        formula.length = 0;
+        formula.constantCount = 0;
+        formula.registers = 0;
+    }
+}
+
+void EvaluateFormulas(const FormulaTable& table, const ExpressionInputs& inputs, MappedControl& mapped)
+{
+    for (int i = 0; i < geo::Num; i++) {
+        if (!((table.mask >> i) & 1u)) {
+            continue;
+        }
+        float value = EvaluateExpression(table.formula[i], inputs, i);
+        mapped.value[i] = value;
+        mapped.activeMask = value != 0.0f ? mapped.activeMask | (1u << i) : mapped.activeMask & ~(1u << i);
+    }
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "mapping.h"
+
+// Формулы отображения из таблицы привязок, например
+// "lefttrigger > 0.5 ? 0 : rightx * 5 * gear".
+// Формула компилируется при загрузке в плоский регистровый байткод без переходов:
+// обе ветви условия вычисляются, результат выбирается командой Select. Поэтому
+// время вычисления ограничено длиной программы, а такт обходится без выделений.
+//
+// Имена: оси SDL (leftx, righty, lefttrigger, ...) с необязательным суффиксом
+// _mean или _peak, кнопки SDL (a, back, leftshoulder, ...) - 1 или 0,
+// gear - масштаб текущей передачи для степени свободы.
+// Функции: abs, sign, min, max, clamp(x, lo, hi), expo(x, k).
+
+const int ExpressionCodeMax = 48;           // Команд в программе
+const int ExpressionRegisterMax = 8;        // Регистров, то есть глубина вложенности
+const int ExpressionConstantMax = 12;
+const int ExpressionCostMax = 64;           // Предел суммарной стоимости команд
+
+namespace ExpressionOp {
+enum Enum : uint8_t {
+    Constant,       // dst = constants[a]
+    Input,          // dst = input[a]
+    Button,         // dst = кнопка a нажата
+    Gear,           // dst = scale[slot]
+    Negate,
+    Not,
+    Abs,
+    Sign,
+    Add,
+    Subtract,
+    Multiply,
+    Divide,         // Деление на ноль дает ноль
+    Less,
+    LessEqual,
+    Greater,
+    GreaterEqual,
+    Equal,
+    NotEqual,
+    And,
+    Or,
+    Min,
+    Max,
+    Expo,           // a * (1 - b) + b * a^3, как в таблице отображения
+    Select,         // dst = a != 0 ? b : c
+    Clamp,          // dst = min(max(a, b), c)
+    Num
+};
+}
+
+struct ExpressionInstruction
+{
+    uint8_t op;
+    uint8_t dst;
+    uint8_t a;
+    uint8_t b;
+    uint8_t c;
+};
+
+// Результат всегда в нулевом регистре
+struct Expression
+{
+    ExpressionInstruction code[ExpressionCodeMax];
+    float constants[ExpressionConstantMax];
+    uint8_t length;
+    uint8_t constantCount;
+    uint8_t registers;
+};
+
+// Вход такта: input[MappingInputCount], scale[MappingWidth], маска нажатых кнопок
+struct ExpressionInputs
+{
+    const float* input;
+    const float* scale;
+    unsigned buttons;
+};
+
+// false и текст ошибки, если формула не разобрана или не прошла проверку
+bool CompileExpression(const char* text, Expression& expression, std::string& error);
+
+// Проверка готовой программы: известные команды, чтение только записанных регистров,
+// индексы в пределах таблиц, стоимость не больше ExpressionCostMax
+bool ValidateExpression(const Expression& expression, std::string& error);
+int ExpressionCost(const Expression& expression);
+
+float EvaluateExpression(const Expression& expression, const ExpressionInputs& inputs, int slot);
+
+// Формулы слоя по степеням свободы
+struct FormulaTable
+{
+    Expression formula[geo::Num];
+    unsigned mask;
+};
+
+void ClearFormulas(FormulaTable& table);
+
+// Подменяет значения слотов с формулами; слот активен, если формула дала не ноль
+void EvaluateFormulas(const FormulaTable& table, const ExpressionInputs& inputs, MappedControl& mapped);
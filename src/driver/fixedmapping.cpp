@@ -0,0 +1,100 @@
+#include "fixedmapping.h"
+
+#include <cmath>
+
+int16_t NormalizeQ15(int raw)
+{
+    if (raw < -Q15One) {
+        return -Q15One;
+    }
+    if (raw > Q15One) {
+        return Q15One;
+    }
+    return static_cast<int16_t>(raw);
+}
+
+int16_t DeadzoneToQ15(float deadzone)
+{
+    // Тот же порог, что и abs(raw / 32767) >= deadzone в плавающей точке
+    return static_cast<int16_t>(std::ceil(static_cast<double>(deadzone) * Q15One));
+}
+
+int16_t ApplyDeadzoneQ15(int32_t value, int16_t deadzone)
+{
+    return static_cast<int16_t>(value >= deadzone || value <= -deadzone ? value : 0);
+}
+
+int32_t ToQ16(float value)
+{
+    double q = std::floor(static_cast<double>(value) * Q16One + 0.5);
+    if (q > INT32_MAX) {
+        return INT32_MAX;
+    }
+    if (q < -INT32_MAX) {
+        return -INT32_MAX;
+    }
+    return static_cast<int32_t>(q);
+}
+
+void CompileFixedMapping(const MappingTable& table, FixedMappingTable& fixed)
+{
+    for (int i = 0; i < MappingWidth; i++) {
+        fixed.gain[i] = ToQ16(table.gain[i]);
+        fixed.expo[i] = static_cast<int32_t>(std::floor(static_cast<double>(table.expo[i]) * 32768 + 0.5));
+        fixed.offset[i] = ToQ16(table.offset[i]);
+        fixed.limit[i] = ToQ16(table.limit[i]);
+        fixed.source[i] = table.source[i];
+    }
+    fixed.sourceMask = table.sourceMask;
+}
+
+void MapControlFixed(const FixedMappingTable& table, const int16_t* input, const int32_t* scale,
+                     FixedMappedControl& out)
+{
+    unsigned mask = 0;
+    for (int i = 0; i < MappingWidth; i++) {
+        int source = table.source[i];
+        int64_t x = source >= 0 ? input[source] : 0;
+
+        int64_t e = table.expo[i];
+        int64_t x3 = ((x * x) >> 15) * x >> 15;
+        int64_t curve = (x * (32768 - e) + e * x3) >> 15;          // Q15
+
+        int64_t k = (static_cast<int64_t>(table.gain[i]) * scale[i]) >> 16;   // Q16.16
+        int64_t y = table.offset[i] + ((k * curve) >> 15);
+
+        int64_t limit = table.limit[i];
+        y = y > limit ? limit : y;
+        y = y < -limit ? -limit : y;
+
+        out.value[i] = static_cast<int32_t>(y);
+        mask |= (x != 0 ? 1u : 0u) << i;
+    }
+    out.activeMask = mask & table.sourceMask;
+}
+
+void MapSamplesFixed(const FixedMappingTable& table, const int32_t* scale, const int16_t* samples, size_t count,
+                     int32_t* values, unsigned* masks)
+{
+    FixedMappedControl mapped;
+    for (size_t i = 0; i < count; i++) {
+        MapControlFixed(table, samples + i * MappingInputCount, scale, mapped);
+        for (int j = 0; j < MappingWidth; j++) {
+            values[i * MappingWidth + j] = mapped.value[j];
+        }
+        if (masks != nullptr) {
+            masks[i] = mapped.activeMask;
+        }
+    }
+}
+
+void ApplyFixedMapping(const MappingTable& table, const FixedMappedControl& mapped, motion::Control& control)
+{
+    unsigned selected = mapped.activeMask | table.constantMask;
+    for (int i = 0; i < geo::Num; i++) {
+        bool active = (selected >> i) & 1u;
+        control.parameters[i].value = static_cast<double>(mapped.value[i]) / Q16One;
+        control.parameters[i].type  = active ? table.activeType[i] : table.idleType[i];
+        control.parameters[i].frame = active ? table.activeFrame[i] : table.idleFrame[i];
+    }
+}
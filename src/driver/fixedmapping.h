@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+
+#include "mapping.h"
+
+// Детерминированный вариант ядра отображения в фиксированной точке.
+// Отсчеты осей - Q15, коэффициенты и результат - Q16.16. Результат переводится
+// в double точно, поэтому motion::Control совпадает побитно между сборками.
+
+const int32_t Q15One = 32767;
+const int32_t Q16One = 65536;
+
+int16_t NormalizeQ15(int raw);
+int16_t DeadzoneToQ15(float deadzone);
+int16_t ApplyDeadzoneQ15(int32_t value, int16_t deadzone);
+int32_t ToQ16(float value);
+
+struct FixedMappingTable
+{
+    int32_t gain[MappingWidth];    // Q16.16
+    int32_t expo[MappingWidth];    // Q15, 0..32768
+    int32_t offset[MappingWidth];  // Q16.16
+    int32_t limit[MappingWidth];   // Q16.16
+
+    int source[MappingWidth];
+    unsigned sourceMask;
+};
+
+struct FixedMappedControl
+{
+    int32_t value[MappingWidth];   // Q16.16
+    unsigned activeMask;
+};
+
+void CompileFixedMapping(const MappingTable& table, FixedMappingTable& fixed);
+
+// input[MappingInputCount] - Q15 после мертвой зоны, scale[MappingWidth] - Q16.16
+void MapControlFixed(const FixedMappingTable& table, const int16_t* input, const int32_t* scale,
+                     FixedMappedControl& out);
+void MapSamplesFixed(const FixedMappingTable& table, const int32_t* scale, const int16_t* samples, size_t count,
+                     int32_t* values, unsigned* masks);
+
+void ApplyFixedMapping(const MappingTable& table, const FixedMappedControl& mapped, motion::Control& control);
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "SDL2/SDL.h"
+#undef main
+
+#include "staticbindings.h"
+
+// Привязки полетной сборки (DEFINES += DRIVER_STATIC_BINDINGS).
+// Совпадают с load/Message--GamepadBindings.json по умолчанию.
+typedef BindingSet<
+    ButtonBinding<CommandAction::StartControl, SDL_CONTROLLER_BUTTON_START>,
+    ButtonBinding<CommandAction::StopControl,  SDL_CONTROLLER_BUTTON_BACK>,
+    ButtonBinding<CommandAction::SetGear,      SDL_CONTROLLER_BUTTON_A, std::ratio<1>>,
+    ButtonBinding<CommandAction::SetGear,      SDL_CONTROLLER_BUTTON_B, std::ratio<2>>,
+    ButtonBinding<CommandAction::SetGear,      SDL_CONTROLLER_BUTTON_X, std::ratio<4>>,
+    ButtonBinding<CommandAction::GearDown,     SDL_CONTROLLER_BUTTON_LEFTSHOULDER>,
+    ButtonBinding<CommandAction::GearUp,       SDL_CONTROLLER_BUTTON_RIGHTSHOULDER>,
+    ButtonBinding<CommandAction::ZeroSpeed,    SDL_CONTROLLER_BUTTON_Y>,
+    AxisBinding<geo::Forward, SDL_CONTROLLER_AXIS_LEFTY,  AxisSample::Last, std::ratio<-5>>,
+    AxisBinding<geo::Yaw,     SDL_CONTROLLER_AXIS_RIGHTX, AxisSample::Last, std::ratio<5>>,
+    ConstantBinding<geo::Up,    std::ratio<25>>,
+    ConstantBinding<geo::Pitch, std::ratio<15, 2>>
+> FlightBindingSet;
+
+typedef StaticBindings<FlightBindingSet> FlightBindings;
@@ -1,11 +1,14 @@
 #include "gamepad.h"
 
+#include <cmath>
+
 Gamepad::Gamepad()
 {
     keys = std::vector<ButtonState>(SDL_CONTROLLER_BUTTON_MAX);
     axes = std::vector<double>(SDL_CONTROLLER_AXIS_MAX);
 
     InitializeKeys();
+    ConfigureDeadzone(DeadzoneSettings());
 }
 
 void Gamepad::InitializeKeys()
@@ -33,6 +36,18 @@ void Gamepad::Close()
 bool Gamepad::Open(int deviceIndex)
 {
     gameController = SDL_GameControllerOpen(deviceIndex);
+    Uint32 now = SDL_GetTicks();
+    for (int i = 0; i < SDL_CONTROLLER_AXIS_MAX; i++) {
+        accumulators[i].Reset(0, now);
+        noiseEstimators[i].Reset();
+        predictors[i].Reset();
+        predicted[i] = 0;
+        axes[i] = 0.0;
+        reportedAxes[i] = 0.0;
+    }
+    activeAxes = 0;
+    dirtyButtons = (1u << ButtonCount) - 1;
+    dirtyAxes = (1u << SDL_CONTROLLER_AXIS_MAX) - 1;
     return gameController != nullptr;
 }
 
@@ -44,6 +59,7 @@ bool Gamepad::IsAtached()
 
 void Gamepad::ClearKeyState() {
       for (int i = 0; i < ButtonCount; i++) {
+          dirtyButtons |= (keys[i].CurrentState ? 1u : 0u) << i;
           keys[i].CurrentState = false;
       }
       buttonEventQueue.clear();
@@ -54,25 +70,130 @@ void Gamepad::SetButtonState(SDL_GameControllerButton button, bool value)
     buttonEventQueue.push_back({button, value});
 }
 
-void Gamepad::SetAxisValue(Axis axis, int value) {
+void Gamepad::SetAxisValue(Axis axis, int value, Uint32 timestamp) {
     int index = static_cast<int>(axis);
     if (index < 0 || index >= axes.size()) {
         return;
     }
 
-    double newValue = static_cast<float>(value) / 32767.f;
-    if (newValue <= -1.0f) {
-        newValue = -1.0f;
+    int16_t raw = NormalizeQ15(value);
+    accumulators[index].Add(raw, timestamp);
+    axes[index] = ApplyDeadzone(raw, index);
+}
+
+void Gamepad::CloseAxisWindows(Uint32 timestamp)
+{
+    for (int i = 0; i < SDL_CONTROLLER_AXIS_MAX; i++) {
+        accumulators[i].Close(timestamp);
+
+        uint32_t bit = 1u << i;
+        double value = ApplyDeadzone(accumulators[i].Get(AxisSample::Last), i);
+        if (value != reportedAxes[i]) {
+            reportedAxes[i] = value;
+            dirtyAxes |= bit;
+        }
+        bool active = value != 0.0;
+        if (active == ((activeAxes & bit) != 0)) {
+            continue;
+        }
+        activeAxes ^= bit;
+        uint32_t trigger = 1u << DispatchTriggerIndex(CommandTrigger::Axis, i);
+        if (active) {
+            inputChanges.pressed |= trigger;
+        }
+        else {
+            inputChanges.released |= trigger;
+        }
+    }
+}
+
+const DispatchMask& Gamepad::GetInputChanges() const
+{
+    return inputChanges;
+}
+
+void Gamepad::GetMappingInput(float* input)
+{
+    const AxisSample samples[MappingSampleCount] = {AxisSample::Last, AxisSample::Mean, AxisSample::Peak};
+    for (int i = 0; i < MappingAxisCount; i++) {
+        for (const auto& sample : samples) {
+            input[MappingSourceIndex(i, sample)] = static_cast<float>(ApplyDeadzone(GetMappingSample(i, sample), i));
+        }
+    }
+}
+
+void Gamepad::GetMappingInputFixed(int16_t* input)
+{
+    const AxisSample samples[MappingSampleCount] = {AxisSample::Last, AxisSample::Mean, AxisSample::Peak};
+    for (int i = 0; i < MappingAxisCount; i++) {
+        int16_t deadzone = noiseEstimators[i].Deadzone();
+        for (const auto& sample : samples) {
+            input[MappingSourceIndex(i, sample)] = ApplyDeadzoneQ15(GetMappingSample(i, sample), deadzone);
+        }
     }
-    else if (newValue >= 1.0f) {
-        newValue = 1.0f;
+}
+
+int32_t Gamepad::GetMappingSample(int index, AxisSample sample) const
+{
+    if (predictionEnabled && sample == AxisSample::Last) {
+        return predicted[index];
     }
+    return accumulators[index].Get(sample);
+}
 
-    axes[index] = abs(newValue) >= DEADZONE ? newValue : 0.0;
+void Gamepad::ConfigurePredictor(const PredictorSettings& settings)
+{
+    predictionEnabled = settings.enabled;
+    for (auto& predictor : predictors) {
+        predictor.Configure(settings);
+    }
+}
+
+void Gamepad::UpdatePredictors(Uint32 timestamp)
+{
+    if (!predictionEnabled) {
+        return;
+    }
+    for (int i = 0; i < SDL_CONTROLLER_AXIS_MAX; i++) {
+        predicted[i] = predictors[i].Update(accumulators[i].Get(AxisSample::Last), timestamp,
+                                            noiseEstimators[i].Deadzone());
+    }
+}
+
+const AxisPredictor& Gamepad::GetPredictor(Axis axis) const
+{
+    return predictors[static_cast<int>(axis)];
+}
+
+double Gamepad::ApplyDeadzone(int32_t raw, int index) const
+{
+    // Порог в Q15 общий с путем фиксированной точки
+    int16_t deadzone = noiseEstimators[index].Deadzone();
+    return std::abs(raw) >= deadzone ? static_cast<double>(raw) / Q15One : 0.0;
+}
+
+void Gamepad::ConfigureDeadzone(const DeadzoneSettings& settings)
+{
+    for (auto& estimator : noiseEstimators) {
+        estimator.Configure(settings);
+    }
+}
+
+void Gamepad::UpdateNoiseEstimate()
+{
+    for (int i = 0; i < SDL_CONTROLLER_AXIS_MAX; i++) {
+        noiseEstimators[i].Update(accumulators[i].Get(AxisSample::Last));
+    }
+}
+
+const NoiseEstimator& Gamepad::GetNoiseEstimate(Axis axis) const
+{
+    return noiseEstimators[static_cast<int>(axis)];
 }
 
 void Gamepad::ProcessPendingKeyEvents()
 {
+   inputChanges = DispatchMask();
    std::vector<ButtonEvent> processedQueue;
    std::vector<bool> used(Gamepad::ButtonCount);
    for (const auto& key : buttonEventQueue) {
@@ -88,10 +209,36 @@ void Gamepad::ProcessPendingKeyEvents()
 
 void Gamepad::SetKeyState(int i, bool state)
 {
+    if (state != keys[i].CurrentState) {
+        dirtyButtons |= 1u << i;
+        uint32_t trigger = 1u << DispatchTriggerIndex(CommandTrigger::Button, i);
+        if (state) {
+            inputChanges.pressed |= trigger;
+        }
+        else {
+            inputChanges.released |= trigger;
+        }
+    }
     keys[i].PreviousState = keys[i].CurrentState;
     keys[i].CurrentState = state;
 }
 
+uint32_t Gamepad::DirtyButtons() const
+{
+    return dirtyButtons;
+}
+
+uint32_t Gamepad::DirtyAxes() const
+{
+    return dirtyAxes;
+}
+
+void Gamepad::ClearDirty()
+{
+    dirtyButtons = 0;
+    dirtyAxes = 0;
+}
+
 bool Gamepad::WasKeyPressed(int i) const
 {
     return keys[i].CurrentState && !keys[i].PreviousState;
@@ -101,22 +248,27 @@ bool Gamepad::IsKeyPressed(int i) const {
     return keys[i].CurrentState;
 }
 
+int16_t Gamepad::GetAxisQ15(int i) const
+{
+    return ApplyDeadzoneQ15(accumulators[i].Get(AxisSample::Last), noiseEstimators[i].Deadzone());
+}
+
 void Gamepad::ConsumeKey(int i)
 {
     keys[i].PreviousState = keys[i].CurrentState;
 }
 
-bool Gamepad::HasValueForAxis(Axis axis) {
-    return abs(GetValueForAxis(axis)) >= DEADZONE;
+bool Gamepad::HasValueForAxis(Axis axis, AxisSample sample) {
+    return GetValueForAxis(axis, sample) != 0.0;
 }
 
-double Gamepad::GetValueForAxis(Axis axis)
+double Gamepad::GetValueForAxis(Axis axis, AxisSample sample)
 {
     int index = static_cast<int>(axis);
     if (index < 0 || index >= axes.size()) {
         return 0;
     }
-    return axes[index];
+    return ApplyDeadzone(accumulators[index].Get(sample), index);
 }
 
 const std::vector<ButtonState>& Gamepad::GetKeys()
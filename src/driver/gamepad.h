@@ -3,6 +3,12 @@
 #include <SDL2/SDL.h>
 #include <vector>
 
+#include "axisaccumulator.h"
+#include "fixedmapping.h"
+#include "noiseestimator.h"
+#include "predictor.h"
+#include "commanddispatch.h"
+
 struct ButtonEvent {
     SDL_GameControllerButton Button;
     bool State;
@@ -39,28 +45,61 @@ public:
     const std::vector<ButtonState>& GetKeys();
     const std::vector<double>& GetAxes();
 
-    double GetValueForAxis(Axis axis);
+    double GetValueForAxis(Axis axis, AxisSample sample = AxisSample::Last);
 
-    bool HasValueForAxis(Axis i);
+    bool HasValueForAxis(Axis i, AxisSample sample = AxisSample::Last);
 
     void SetButtonState(SDL_GameControllerButton button, bool value);
-    void SetAxisValue(Axis axis, int value);
+    void SetAxisValue(Axis axis, int value, Uint32 timestamp);
+    void CloseAxisWindows(Uint32 timestamp);
+    void GetMappingInput(float* input);
+    void GetMappingInputFixed(int16_t* input);
+    void ConfigureDeadzone(const DeadzoneSettings& settings);
+    void UpdateNoiseEstimate();
+    const NoiseEstimator& GetNoiseEstimate(Axis axis) const;
+    void ConfigurePredictor(const PredictorSettings& settings);
+    void UpdatePredictors(Uint32 timestamp);
+    const AxisPredictor& GetPredictor(Axis axis) const;
+
+    // Нажатия и отпускания за такт: кнопки после ProcessPendingKeyEvents,
+    // оси (выход из мертвой зоны и возврат) после CloseAxisWindows
+    const DispatchMask& GetInputChanges() const;
     bool WasKeyPressed(int i) const;
     bool IsKeyPressed(int i) const;
+    // Последний отсчет оси после мертвой зоны, Q15
+    int16_t GetAxisQ15(int i) const;
     void ConsumeKey(int i);
     void ProcessPendingKeyEvents();
     bool IsAtached();
     void ClearKeyState();
 
+    // Кнопки и оси (значение после мертвой зоны), изменившиеся с последнего ClearDirty.
+    // После подключения устройства помечено все.
+    uint32_t DirtyButtons() const;
+    uint32_t DirtyAxes() const;
+    void ClearDirty();
+
 private:
     const int HOLD_THRESHOLD_MS = 300;
-    const float DEADZONE = 0.2f;
 
     void InitializeKeys();
     void SetKeyState(int i, bool state);
+    double ApplyDeadzone(int32_t raw, int index) const;
+    int32_t GetMappingSample(int index, AxisSample sample) const;
 
     SDL_GameController* gameController;
     std::vector<ButtonState> keys;
     std::vector<double> axes;
+    AxisAccumulator accumulators[SDL_CONTROLLER_AXIS_MAX];
+    NoiseEstimator noiseEstimators[SDL_CONTROLLER_AXIS_MAX];
+    AxisPredictor predictors[SDL_CONTROLLER_AXIS_MAX];
+    int32_t predicted[SDL_CONTROLLER_AXIS_MAX] = {};
+    bool predictionEnabled = false;
+
+    DispatchMask inputChanges;
+    uint32_t activeAxes = 0;
+    uint32_t dirtyButtons = 0;
+    uint32_t dirtyAxes = 0;
+    double reportedAxes[SDL_CONTROLLER_AXIS_MAX] = {};
     std::vector<ButtonEvent> buttonEventQueue;
 };
@@ -0,0 +1,89 @@
+#include "latencyhistogram.h"
+
+static const int Half = 1 << (LatencyHistogram::SubBits - 1);
+
+void LatencyHistogram::Reset()
+{
+    *this = LatencyHistogram();
+}
+
+// До 2^SubBits корзина на каждое значение, дальше 16 корзин на степень двойки
+int LatencyHistogram::Index(uint64_t value)
+{
+    if (value < static_cast<uint64_t>(2 * Half)) {
+        return static_cast<int>(value);
+    }
+    int msb = 0;
+    while (value >> (msb + 1)) {
+        msb++;
+    }
+    int shift = msb - (SubBits - 1);
+    int index = (shift + 1) * Half + static_cast<int>(value >> shift) - Half;
+    return index < BucketCount ? index : BucketCount - 1;
+}
+
+uint64_t LatencyHistogram::Highest(int index)
+{
+    if (index < 2 * Half) {
+        return static_cast<uint64_t>(index);
+    }
+    int shift = index / Half - 1;
+    uint64_t sub = static_cast<uint64_t>(index % Half + Half);
+    return ((sub + 1) << shift) - 1;
+}
+
+void LatencyHistogram::Record(uint64_t value)
+{
+    buckets[Index(value)]++;
+    if (count == 0 || value < min) {
+        min = value;
+    }
+    if (value > max) {
+        max = value;
+    }
+    count++;
+    sum += value;
+}
+
+uint32_t LatencyHistogram::Count() const
+{
+    return count;
+}
+
+uint64_t LatencyHistogram::Min() const
+{
+    return min;
+}
+
+uint64_t LatencyHistogram::Max() const
+{
+    return max;
+}
+
+double LatencyHistogram::Mean() const
+{
+    return count > 0 ? static_cast<double>(sum) / count : 0.0;
+}
+
+uint64_t LatencyHistogram::Percentile(double fraction) const
+{
+    if (count == 0) {
+        return 0;
+    }
+    uint64_t target = static_cast<uint64_t>(fraction * count + 0.5);
+    if (target < 1) {
+        target = 1;
+    }
+    uint64_t seen = 0;
+    for (int i = 0; i < BucketCount; i++) {
+        seen += buckets[i];
+        if (seen >= target) {
+            if (i == BucketCount - 1) {
+                return max;
+            }
+            uint64_t highest = Highest(i);
+            return highest < max ? highest : max;
+        }
+    }
+    return max;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstdint>
+
+// Гистограмма задержек в микросекундах по образцу HDR: на каждую степень двойки
+// 16 корзин, относительная погрешность не хуже 1/16. Память постоянная, значения
+// от 2^24 мкс (16 с) попадают в последнюю корзину.
+class LatencyHistogram
+{
+public:
+    static const int SubBits = 5;
+    static const int MaxBits = 24;
+    static const int BucketCount = (MaxBits - SubBits + 2) << (SubBits - 1);
+
+    void Reset();
+    void Record(uint64_t value);
+
+    uint32_t Count() const;
+    uint64_t Min() const;
+    uint64_t Max() const;
+    double Mean() const;
+
+    // Наибольшее значение корзины, в которую попадает доля fraction записей
+    uint64_t Percentile(double fraction) const;
+
+private:
+    static int Index(uint64_t value);
+    static uint64_t Highest(int index);
+
+    uint32_t buckets[BucketCount] = {};
+    uint32_t count = 0;
+    uint64_t sum = 0;
+    uint64_t min = 0;
+    uint64_t max = 0;
+};
@@ -0,0 +1,90 @@
+#include "linkadapter.h"
+
+#include <algorithm>
+#include <cmath>
+
+void LinkAdapter::Configure(const LinkAdapterSettings& settings, double interval, double timeLimit)
+{
+    this->settings = settings;
+    this->interval = std::max(settings.intervalMin, std::min(settings.intervalMax, interval));
+    this->timeLimit = std::max(settings.timeLimitMin, std::min(settings.timeLimitMax, timeLimit));
+    hasRtt = false;
+    congested = false;
+    margin = 0;
+    lossAvg = 0;
+    series = 2;
+}
+
+void LinkAdapter::RttSample(double rtt)
+{
+    if (!hasRtt) {
+        srtt = rtt;
+        rttvar = rtt / 2;
+        rttMin = rtt;
+        hasRtt = true;
+        return;
+    }
+    rttvar = 0.75 * rttvar + 0.25 * std::fabs(srtt - rtt);
+    srtt = 0.875 * srtt + 0.125 * rtt;
+    rttMin = std::min(rttMin, rtt);
+}
+
+double LinkAdapter::Limit(double current, double target) const
+{
+    return std::max(current / settings.step, std::min(current * settings.step, target));
+}
+
+bool LinkAdapter::Update(double loss, int queueDepth)
+{
+    double keepalive = Keepalive();
+    congested = queueDepth > settings.queueTarget
+            || (hasRtt && srtt > 2 * rttMin + settings.rttSlack);
+    double target = congested ? interval * settings.backoff : interval - settings.speedup;
+    target = std::max(settings.intervalMin, std::min(settings.intervalMax, target));
+    double nextInterval = Limit(interval, target);
+
+    // Потерь подряд, которые команда переживает до истечения time_limit. Доля потерь
+    // за один период диагностики шумит, серия берется по худшей из нее и сглаженной
+    lossAvg = 0.875 * lossAvg + 0.125 * loss;
+    double worst = std::max(loss, lossAvg);
+    series = 2;
+    if (worst > 0) {
+        double p = std::min(worst, 0.9);
+        series = std::max(series, static_cast<int>(std::ceil(std::log(settings.residual) / std::log(p))));
+    }
+    margin = hasRtt ? srtt + 4 * rttvar : 0;
+    double limitTarget = margin + series * nextInterval;
+    limitTarget = std::max(settings.timeLimitMin, std::min(settings.timeLimitMax, limitTarget));
+    double nextTimeLimit = Limit(timeLimit, limitTarget);
+
+    bool changed = std::fabs(nextInterval - interval) > 1e-6 || std::fabs(nextTimeLimit - timeLimit) > 1e-6;
+    interval = nextInterval;
+    timeLimit = nextTimeLimit;
+    return changed || std::fabs(Keepalive() - keepalive) > 1e-3;
+}
+
+double LinkAdapter::Interval() const
+{
+    return interval;
+}
+
+double LinkAdapter::TimeLimit() const
+{
+    return timeLimit;
+}
+
+double LinkAdapter::Keepalive() const
+{
+    // time_limit ограничен сверху и шагом, поэтому период берется от текущего значения
+    return std::max(interval, (timeLimit - margin) / series);
+}
+
+double LinkAdapter::Rtt() const
+{
+    return srtt;
+}
+
+bool LinkAdapter::IsCongested() const
+{
+    return congested;
+}
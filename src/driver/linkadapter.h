@@ -0,0 +1,57 @@
+#pragma once
+
+struct LinkAdapterSettings
+{
+    double intervalMin = 0.02;      // Период отправки, с
+    double intervalMax = 0.5;
+    double timeLimitMin = 0.5;      // time_limit команды, с
+    double timeLimitMax = 5.0;
+    double step = 1.5;              // Наибольшее изменение за шаг, раз
+    double backoff = 1.25;          // Замедление отправки при перегрузке за шаг, раз
+    double speedup = 0.01;          // Ускорение отправки на чистом канале за шаг, с
+    int    queueTarget = 2;         // Очередь получателя, выше которой отправка замедляется
+    double rttSlack = 0.01;         // Рост RTT сверх двойного наименьшего, признак очереди, с
+    double residual = 0.001;        // Допустимая вероятность истечения time_limit из-за потерь подряд
+};
+
+// Подстройка периода отправки и time_limit под канал. Очередь у получателя
+// или рост RTT - перегрузка: период растет в backoff раз. Иначе период
+// сокращается на speedup: потери без очереди лечатся частой отправкой, а не
+// редкой. time_limit покрывает RTT с запасом и столько периодов, чтобы серия
+// потерь подряд истекала с вероятностью не выше residual. Оба значения
+// остаются в границах и за шаг меняются не более чем в step раз. Неизменная
+// команда повторяется с периодом Keepalive, чтобы в time_limit поместилась
+// та же серия потерь, что и при отправке каждый период.
+class LinkAdapter
+{
+public:
+    void Configure(const LinkAdapterSettings& settings, double interval, double timeLimit);
+
+    // Замер RTT по подтверждению, с; сглаживается как в TCP
+    void RttSample(double rtt);
+
+    // Итог периода диагностики; true - период, time_limit или повтор изменились
+    bool Update(double loss, int queueDepth);
+
+    double Interval() const;
+    double TimeLimit() const;
+    // Период повтора неизменной команды, с: серия повторов за вычетом RTT укладывается в time_limit
+    double Keepalive() const;
+    double Rtt() const;
+    bool IsCongested() const;
+
+private:
+    double Limit(double current, double target) const;
+
+    LinkAdapterSettings settings;
+    double interval = 0.1;
+    double timeLimit = 2.0;
+    double srtt = 0;
+    double rttvar = 0;
+    double rttMin = 0;
+    double margin = 0;
+    double lossAvg = 0;
+    int series = 2;
+    bool hasRtt = false;
+    bool congested = false;
+};
@@ -0,0 +1,97 @@
+#include "looplatency.h"
+
+#include <cmath>
+
+void LoopLatency::Configure(const LoopLatencySettings& settings)
+{
+    this->settings = settings;
+}
+
+void LoopLatency::Reset()
+{
+    histogram.Reset();
+    hasControl = false;
+    hasForces = false;
+    pending = false;
+    timeouts = 0;
+}
+
+bool LoopLatency::ControlChanged(const motion::Control& control) const
+{
+    if (!hasControl) {
+        return true;
+    }
+    for (int i = 0; i < geo::Num; i++) {
+        const motion::ControlParameter& a = control.parameters[i];
+        const motion::ControlParameter& b = lastControl.parameters[i];
+        if (a.value != b.value || a.type != b.type || a.frame != b.frame) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool LoopLatency::IsNeutral(const motion::Control& control)
+{
+    for (int i = 0; i < geo::Num; i++) {
+        if (control.parameters[i].value != 0.0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void LoopLatency::ControlSent(const motion::Control& control, uint64_t now)
+{
+    Expire(now);
+    if (ControlChanged(control) && !pending && hasForces) {
+        pending = true;
+        probeTime = now;
+    }
+    lastControl = control;
+    hasControl = true;
+}
+
+void LoopLatency::WorkReceived(bool ours)
+{
+    this->ours = ours;
+}
+
+void LoopLatency::ForcesReceived(const motion::Forces& forces, uint64_t now)
+{
+    Expire(now);
+    bool changed = false;
+    bool zero = true;
+    for (int i = 0; i < geo::Num; i++) {
+        changed = changed || std::fabs(forces.limit[i] - lastForces[i]) > settings.tolerance;
+        zero = zero && std::fabs(forces.limit[i]) <= settings.tolerance;
+        lastForces[i] = forces.limit[i];
+    }
+    // Силы ушли в ноль при ненулевой команде - истек time_limit или сработала защита, а не отклик
+    if (zero && !IsNeutral(lastControl)) {
+        changed = false;
+    }
+    if (pending && changed && ours) {
+        histogram.Record(now - probeTime);
+        pending = false;
+    }
+    hasForces = true;
+}
+
+void LoopLatency::Expire(uint64_t now)
+{
+    if (pending && now - probeTime > settings.timeout) {
+        pending = false;
+        timeouts++;
+    }
+}
+
+const LatencyHistogram& LoopLatency::Histogram() const
+{
+    return histogram;
+}
+
+uint32_t LoopLatency::Timeouts() const
+{
+    return timeouts;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+
+#include "latencyhistogram.h"
+#include "motion.h"
+
+struct LoopLatencySettings
+{
+    uint64_t timeout = 2000000;     // Ожидание изменения сил, мкс
+    double   tolerance = 0.01;      // Изменение силы или момента, которое считается откликом
+};
+
+// Задержка замкнутого контура: от отправки изменившейся команды до первого
+// изменения motion::Forces. Одновременно ждет одна проба; команды, ушедшие
+// во время ожидания, относятся к ней же, так что отклик не приписывается
+// более поздней команде. Пока motion::Work сообщает чужой приоритет,
+// изменения сил вызваны не нами и пробу не закрывают, как и обнуление сил
+// при ненулевой команде.
+class LoopLatency
+{
+public:
+    void Configure(const LoopLatencySettings& settings);
+    void Reset();
+
+    void ControlSent(const motion::Control& control, uint64_t now);
+    void WorkReceived(bool ours);
+    void ForcesReceived(const motion::Forces& forces, uint64_t now);
+
+    // Проба без отклика дольше timeout снимается
+    void Expire(uint64_t now);
+
+    const LatencyHistogram& Histogram() const;
+    uint32_t Timeouts() const;
+
+private:
+    bool ControlChanged(const motion::Control& control) const;
+    static bool IsNeutral(const motion::Control& control);
+
+    LoopLatencySettings settings;
+    LatencyHistogram histogram;
+    motion::Control lastControl;
+    double lastForces[geo::Num] = {};
+    bool hasControl = false;
+    bool hasForces = false;
+    bool ours = true;
+    bool pending = false;
+    uint64_t probeTime = 0;
+    uint32_t timeouts = 0;
+};
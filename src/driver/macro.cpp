@@ -0,0 +1,162 @@
+#include "macro.h"
+
+#include <cstdio>
+#include <cstring>
+
+static const char MacroMagic[4] = {'A', 'U', 'V', 'M'};
+static const uint32_t MacroVersion = 1;
+
+void ControlMacro::Clear()
+{
+    count = 0;
+}
+
+bool ControlMacro::Append(uint32_t time, const motion::Control& control)
+{
+    if (count >= MacroCapacity) {
+        return false;
+    }
+    MacroFrame& frame = frames[count++];
+    frame.time = time;
+    for (int i = 0; i < geo::Num; i++) {
+        frame.value[i] = static_cast<float>(control.parameters[i].value);
+        frame.type[i] = static_cast<int8_t>(control.parameters[i].type);
+        frame.frame[i] = static_cast<int8_t>(control.parameters[i].frame);
+    }
+    return true;
+}
+
+int ControlMacro::Count() const
+{
+    return count;
+}
+
+uint32_t ControlMacro::Duration() const
+{
+    return count > 0 ? frames[count - 1].time : 0;
+}
+
+const MacroFrame& ControlMacro::Frame(int index) const
+{
+    return frames[index];
+}
+
+void ControlMacro::Apply(const MacroFrame& frame, motion::Control& control)
+{
+    for (int i = 0; i < geo::Num; i++) {
+        control.parameters[i].value = frame.value[i];
+        control.parameters[i].type = motion::ControlType::Enum(frame.type[i]);
+        control.parameters[i].frame = scene::Object(frame.frame[i]);
+    }
+}
+
+bool ControlMacro::Save(const std::string& path) const
+{
+    FILE* file = fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+        return false;
+    }
+    uint32_t header[2] = {MacroVersion, static_cast<uint32_t>(count)};
+    bool ok = fwrite(MacroMagic, sizeof(MacroMagic), 1, file) == 1
+           && fwrite(header, sizeof(header), 1, file) == 1
+           && (count == 0 || fwrite(frames, sizeof(MacroFrame), count, file) == static_cast<size_t>(count));
+    fclose(file);
+    return ok;
+}
+
+bool ControlMacro::Load(const std::string& path)
+{
+    count = 0;
+    FILE* file = fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        return false;
+    }
+    char magic[4];
+    uint32_t header[2];
+    bool ok = fread(magic, sizeof(magic), 1, file) == 1
+           && memcmp(magic, MacroMagic, sizeof(magic)) == 0
+           && fread(header, sizeof(header), 1, file) == 1
+           && header[0] == MacroVersion
+           && header[1] <= static_cast<uint32_t>(MacroCapacity);
+    if (ok) {
+        ok = fread(frames, sizeof(MacroFrame), header[1], file) == header[1];
+    }
+    fclose(file);
+    count = ok ? static_cast<int>(header[1]) : 0;
+    return ok;
+}
+
+void MacroPlayer::StartRecording(ControlMacro* macro, int slot, uint32_t now)
+{
+    Cancel();
+    macro->Clear();
+    recording = macro;
+    this->slot = slot;
+    start = now;
+    mode = Mode::Recording;
+}
+
+void MacroPlayer::Record(const motion::Control& control, uint32_t now)
+{
+    if (mode != Mode::Recording) {
+        return;
+    }
+    // Переполненный буфер заканчивает запись
+    if (!recording->Append(now - start, control)) {
+        StopRecording();
+    }
+}
+
+void MacroPlayer::StopRecording()
+{
+    if (mode == Mode::Recording) {
+        mode = Mode::Idle;
+    }
+}
+
+bool MacroPlayer::StartPlayback(const ControlMacro* macro, int slot, uint32_t now)
+{
+    if (mode == Mode::Recording || macro->Count() == 0) {
+        return false;
+    }
+    playing = macro;
+    this->slot = slot;
+    start = now;
+    position = 0;
+    mode = Mode::Playing;
+    return true;
+}
+
+const MacroFrame* MacroPlayer::Next(uint32_t now)
+{
+    if (mode != Mode::Playing) {
+        return nullptr;
+    }
+    // При опоздании такта пропущенные кадры не догоняются, берется последний наступивший
+    const MacroFrame* due = nullptr;
+    uint32_t elapsed = now - start;
+    while (position < playing->Count() && playing->Frame(position).time <= elapsed) {
+        due = &playing->Frame(position++);
+    }
+    if (position >= playing->Count()) {
+        mode = Mode::Idle;
+    }
+    return due;
+}
+
+void MacroPlayer::Cancel()
+{
+    if (mode == Mode::Playing) {
+        mode = Mode::Idle;
+    }
+}
+
+MacroPlayer::Mode MacroPlayer::GetMode() const
+{
+    return mode;
+}
+
+int MacroPlayer::Slot() const
+{
+    return slot;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "motion.h"
+
+const int MacroCapacity = 1024;     // Кадров на макрос: 100 с при такте 0,1 с
+const int MacroSlots = 4;
+
+// Кадр макроса: отправленная команда и ее смещение от начала записи
+struct MacroFrame
+{
+    uint32_t time;                  // мс
+    float value[geo::Num];
+    int8_t type[geo::Num];
+    int8_t frame[geo::Num];
+};
+
+// Записанная последовательность команд в буфере фиксированного размера.
+// Файл: заголовок AUVM, версия, число кадров, затем кадры как есть.
+class ControlMacro
+{
+public:
+    void Clear();
+    bool Append(uint32_t time, const motion::Control& control);
+
+    int Count() const;
+    uint32_t Duration() const;
+    const MacroFrame& Frame(int index) const;
+
+    static void Apply(const MacroFrame& frame, motion::Control& control);
+
+    bool Save(const std::string& path) const;
+    bool Load(const std::string& path);
+
+private:
+    MacroFrame frames[MacroCapacity];
+    int count = 0;
+};
+
+// Запись и воспроизведение по тактам управления. Воспроизведение только
+// читает заранее загруженный буфер и ничего не выделяет.
+class MacroPlayer
+{
+public:
+    enum class Mode
+    {
+        Idle,
+        Recording,
+        Playing
+    };
+
+    void StartRecording(ControlMacro* macro, int slot, uint32_t now);
+    void Record(const motion::Control& control, uint32_t now);
+    void StopRecording();
+
+    bool StartPlayback(const ControlMacro* macro, int slot, uint32_t now);
+    // Последний наступивший кадр или nullptr, если на этом такте слать нечего
+    const MacroFrame* Next(uint32_t now);
+    void Cancel();
+
+    Mode GetMode() const;
+    int Slot() const;
+
+private:
+    Mode mode = Mode::Idle;
+    int slot = -1;
+    uint32_t start = 0;
+    ControlMacro* recording = nullptr;
+    const ControlMacro* playing = nullptr;
+    int position = 0;
+};
@@ -0,0 +1,213 @@
+#include "mapping.h"
+
+#include <cfloat>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define MAPPING_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MAPPING_SSE
+#endif
+
+void ClearMapping(MappingTable& table)
+{
+    for (int i = 0; i < MappingWidth; i++) {
+        table.gain[i] = 0;
+        table.expo[i] = 0;
+        table.offset[i] = 0;
+        table.limit[i] = FLT_MAX;
+        table.source[i] = MappingNoSource;
+    }
+    for (int i = 0; i < geo::Num; i++) {
+        table.activeType[i] = motion::ControlType::Force;
+        table.activeFrame[i] = scene::Absent;
+        table.idleType[i] = motion::ControlType::Force;
+        table.idleFrame[i] = scene::Absent;
+    }
+    table.sourceMask = 0;
+    table.constantMask = 0;
+}
+
+void BindMappingAxis(MappingTable& table, geo::Axis slot, int source, float gain, float expo,
+                     motion::ControlType::Enum type, scene::Object frame)
+{
+    if (source < 0 || source >= MappingInputCount) {
+        return;
+    }
+    table.source[slot] = source;
+    table.gain[slot] = gain;
+    table.expo[slot] = expo;
+    table.activeType[slot] = type;
+    table.activeFrame[slot] = frame;
+    table.sourceMask |= 1u << slot;
+}
+
+void BindMappingConstant(MappingTable& table, geo::Axis slot, float value,
+                         motion::ControlType::Enum type, scene::Object frame)
+{
+    table.offset[slot] = value;
+    table.activeType[slot] = type;
+    table.activeFrame[slot] = frame;
+    table.constantMask |= 1u << slot;
+}
+
+void BindMappingFormula(MappingTable& table, geo::Axis slot, motion::ControlType::Enum type, scene::Object frame)
+{
+    table.source[slot] = MappingNoSource;
+    table.gain[slot] = 0;
+    table.offset[slot] = 0;
+    table.activeType[slot] = type;
+    table.activeFrame[slot] = frame;
+    table.sourceMask &= ~(1u << slot);
+    table.constantMask &= ~(1u << slot);
+}
+
+// Выбор входов по таблице источников; отсутствующий источник дает ноль
+static inline void GatherLanes(const MappingTable& table, const float* input, float* lanes)
+{
+    for (int i = 0; i < MappingWidth; i++) {
+        int source = table.source[i];
+        lanes[i] = source >= 0 ? input[source] : 0.0f;
+    }
+}
+
+void MapControlScalar(const MappingTable& table, const float* input, const float* scale, MappedControl& out)
+{
+    float lanes[MappingWidth];
+    GatherLanes(table, input, lanes);
+
+    unsigned mask = 0;
+    for (int i = 0; i < MappingWidth; i++) {
+        float x = lanes[i];
+        float e = table.expo[i];
+        float curve = x * (1.0f - e) + e * x * x * x;
+        float y = table.offset[i] + table.gain[i] * scale[i] * curve;
+        float limit = table.limit[i];
+        y = y > limit ? limit : y;
+        y = y < -limit ? -limit : y;
+        out.value[i] = y;
+        mask |= (x != 0.0f ? 1u : 0u) << i;
+    }
+    out.activeMask = mask & table.sourceMask;
+}
+
+#if defined(MAPPING_AVX)
+
+void MapControl(const MappingTable& table, const float* input, const float* scale, MappedControl& out)
+{
+    alignas(32) float lanes[MappingWidth];
+    GatherLanes(table, input, lanes);
+
+    const __m256 one = _mm256_set1_ps(1.0f);
+    __m256 x = _mm256_load_ps(lanes);
+    __m256 e = _mm256_load_ps(table.expo);
+    __m256 x3 = _mm256_mul_ps(_mm256_mul_ps(x, x), x);
+    __m256 curve = _mm256_add_ps(_mm256_mul_ps(x, _mm256_sub_ps(one, e)), _mm256_mul_ps(e, x3));
+    __m256 k = _mm256_mul_ps(_mm256_load_ps(table.gain), _mm256_loadu_ps(scale));
+    __m256 y = _mm256_add_ps(_mm256_load_ps(table.offset), _mm256_mul_ps(k, curve));
+    __m256 limit = _mm256_load_ps(table.limit);
+    y = _mm256_min_ps(y, limit);
+    y = _mm256_max_ps(y, _mm256_sub_ps(_mm256_setzero_ps(), limit));
+    _mm256_store_ps(out.value, y);
+
+    unsigned mask = _mm256_movemask_ps(_mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_NEQ_UQ));
+    out.activeMask = mask & table.sourceMask;
+}
+
+const char* MappingKernelName()
+{
+    return "AVX";
+}
+
+#elif defined(MAPPING_SSE)
+
+static inline __m128 MapHalf(__m128 x, const float* gain, const float* expo, const float* offset,
+                             const float* limit, const float* scale)
+{
+    const __m128 one = _mm_set1_ps(1.0f);
+    __m128 e = _mm_load_ps(expo);
+    __m128 x3 = _mm_mul_ps(_mm_mul_ps(x, x), x);
+    __m128 curve = _mm_add_ps(_mm_mul_ps(x, _mm_sub_ps(one, e)), _mm_mul_ps(e, x3));
+    __m128 k = _mm_mul_ps(_mm_load_ps(gain), _mm_loadu_ps(scale));
+    __m128 y = _mm_add_ps(_mm_load_ps(offset), _mm_mul_ps(k, curve));
+    __m128 l = _mm_load_ps(limit);
+    y = _mm_min_ps(y, l);
+    return _mm_max_ps(y, _mm_sub_ps(_mm_setzero_ps(), l));
+}
+
+void MapControl(const MappingTable& table, const float* input, const float* scale, MappedControl& out)
+{
+    alignas(16) float lanes[MappingWidth];
+    GatherLanes(table, input, lanes);
+
+    __m128 lo = _mm_load_ps(lanes);
+    __m128 hi = _mm_load_ps(lanes + 4);
+    _mm_store_ps(out.value, MapHalf(lo, table.gain, table.expo, table.offset, table.limit, scale));
+    _mm_store_ps(out.value + 4, MapHalf(hi, table.gain + 4, table.expo + 4, table.offset + 4,
+                                        table.limit + 4, scale + 4));
+
+    unsigned mask = _mm_movemask_ps(_mm_cmpneq_ps(lo, _mm_setzero_ps()))
+                 | (_mm_movemask_ps(_mm_cmpneq_ps(hi, _mm_setzero_ps())) << 4);
+    out.activeMask = mask & table.sourceMask;
+}
+
+const char* MappingKernelName()
+{
+    return "SSE";
+}
+
+#else
+
+void MapControl(const MappingTable& table, const float* input, const float* scale, MappedControl& out)
+{
+    MapControlScalar(table, input, scale, out);
+}
+
+const char* MappingKernelName()
+{
+    return "scalar";
+}
+
+#endif
+
+void MapSamples(const MappingTable& table, const float* scale, const float* samples, size_t count,
+                float* values, unsigned* masks)
+{
+    MappedControl mapped;
+    for (size_t i = 0; i < count; i++) {
+        MapControl(table, samples + i * MappingInputCount, scale, mapped);
+        for (int j = 0; j < MappingWidth; j++) {
+            values[i * MappingWidth + j] = mapped.value[j];
+        }
+        if (masks != nullptr) {
+            masks[i] = mapped.activeMask;
+        }
+    }
+}
+
+void MapSamplesScalar(const MappingTable& table, const float* scale, const float* samples, size_t count,
+                      float* values, unsigned* masks)
+{
+    MappedControl mapped;
+    for (size_t i = 0; i < count; i++) {
+        MapControlScalar(table, samples + i * MappingInputCount, scale, mapped);
+        for (int j = 0; j < MappingWidth; j++) {
+            values[i * MappingWidth + j] = mapped.value[j];
+        }
+        if (masks != nullptr) {
+            masks[i] = mapped.activeMask;
+        }
+    }
+}
+
+void ApplyMapping(const MappingTable& table, const MappedControl& mapped, motion::Control& control)
+{
+    unsigned selected = mapped.activeMask | table.constantMask;
+    for (int i = 0; i < geo::Num; i++) {
+        bool active = (selected >> i) & 1u;
+        control.parameters[i].value = mapped.value[i];
+        control.parameters[i].type  = active ? table.activeType[i] : table.idleType[i];
+        control.parameters[i].frame = active ? table.activeFrame[i] : table.idleFrame[i];
+    }
+}
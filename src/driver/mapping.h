@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+
+#include "axisaccumulator.h"
+#include "motion.h"
+
+// Пакетное преобразование входа геймпада в motion::Control.
+// Все степени свободы обрабатываются одним ядром над массивами фиксированной
+// ширины: выбор источника, масштаб, кривая, ограничение и система координат.
+
+const int MappingWidth = 8;                                      // geo::Num, дополненное до ширины AVX
+const int MappingAxisCount = 6;                                  // SDL_CONTROLLER_AXIS_MAX
+const int MappingSampleCount = 3;                                // Last, Mean, Peak
+const int MappingInputCount = MappingAxisCount * MappingSampleCount;
+const int MappingNoSource = -1;
+
+// Индекс входа для оси и выбранного отсчета за период
+inline int MappingSourceIndex(int axis, AxisSample sample)
+{
+    return static_cast<int>(sample) * MappingAxisCount + axis;
+}
+
+struct MappingTable
+{
+    alignas(32) float gain[MappingWidth];    // Коэффициент отклонения ручки
+    alignas(32) float expo[MappingWidth];    // Доля кубической составляющей кривой
+    alignas(32) float offset[MappingWidth];  // Постоянная составляющая
+    alignas(32) float limit[MappingWidth];   // Ограничение результата по модулю
+
+    int source[MappingWidth];                // Индекс входа или MappingNoSource
+    unsigned sourceMask;                     // Слоты, управляемые осями
+    unsigned constantMask;                   // Слоты с постоянным заданием
+
+    motion::ControlType::Enum activeType[geo::Num];
+    scene::Object             activeFrame[geo::Num];
+    motion::ControlType::Enum idleType[geo::Num];
+    scene::Object             idleFrame[geo::Num];
+};
+
+struct MappedControl
+{
+    alignas(32) float value[MappingWidth];
+    unsigned activeMask;                     // Слоты, где ось вне мертвой зоны
+};
+
+void ClearMapping(MappingTable& table);
+void BindMappingAxis(MappingTable& table, geo::Axis slot, int source, float gain, float expo,
+                     motion::ControlType::Enum type, scene::Object frame);
+void BindMappingConstant(MappingTable& table, geo::Axis slot, float value,
+                         motion::ControlType::Enum type, scene::Object frame);
+// Значение слота задает формула после ядра (EvaluateFormulas), таблица хранит только тип и систему
+void BindMappingFormula(MappingTable& table, geo::Axis slot, motion::ControlType::Enum type, scene::Object frame);
+
+// Один отсчет: input[MappingInputCount], scale[MappingWidth]
+void MapControl(const MappingTable& table, const float* input, const float* scale, MappedControl& out);
+void MapControlScalar(const MappingTable& table, const float* input, const float* scale, MappedControl& out);
+
+// Записанные отсчеты для офлайн-анализа: samples[count][MappingInputCount],
+// values[count][MappingWidth], masks[count] (может быть nullptr)
+void MapSamples(const MappingTable& table, const float* scale, const float* samples, size_t count,
+                float* values, unsigned* masks);
+void MapSamplesScalar(const MappingTable& table, const float* scale, const float* samples, size_t count,
+                      float* values, unsigned* masks);
+
+void ApplyMapping(const MappingTable& table, const MappedControl& mapped, motion::Control& control);
+
+const char* MappingKernelName();
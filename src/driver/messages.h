@@ -3,6 +3,18 @@
 #pragma pack(push,1)          // Выставляем однобайтовое выравнивание!!!
 
 namespace Message {
+    // Метка отправки: номер у отправителя и монотонное время, по ним получатель считает потери
+    struct Stamp {
+        uint32_t sequence;
+        uint64_t timestamp;
+        ipc::Schema schema() {
+            return ipc::Schema(this).title("Метка отправки")
+               .add(IPC_INT(sequence).title("Номер отправки").default_(0))
+               .add(IPC_INT(timestamp).title("Время отправки").unit("мкс").default_(0))
+               ;
+        }
+    };
+
     struct ButtonState {
         ipc::String<15> name;
         bool isPressed;
@@ -30,6 +42,7 @@ namespace Message {
         }
     };
 
+    // Прежний формат для существующих приемников, без метки: раскладка не меняется
     struct GamepadState {
         ButtonState buttonStates[21];
         AxisState axesState[4];
@@ -43,10 +56,164 @@ namespace Message {
         }
     };
 
+    // Компактная телеметрия геймпада: имена и порядок полей - в GamepadLayout.
+    // Номер и время (SDL_GetTicks, монотонное) заменяют метку отправки.
+    struct GamepadTelemetry {
+        uint32_t sequence;
+        uint32_t timestamp;
+        uint32_t buttons;
+        int16_t axes[6];
+        ipc::Schema schema() {
+            return ipc::Schema(this).title("Телеметрия геймпада")
+               .add(IPC_INT(sequence).title("Номер отсчета").default_(0))
+               .add(IPC_INT(timestamp).title("Время отсчета").unit("мс").default_(0))
+               .add(IPC_INT(buttons).title("Нажатые кнопки, бит на кнопку").default_(0))
+               .add(IPC_INTS(axes).title("Оси после мертвой зоны, Q15").element_default(0))
+               ;
+        }
+    };
+
+    // Раскладка телеметрии: отправляется при подключении геймпада
+    struct GamepadLayout {
+        Stamp stamp;
+        int version;
+        ipc::String<15> buttons[21];
+        ipc::String<15> axes[6];
+        ipc::Schema schema() {
+            return ipc::Schema(this).title("Раскладка телеметрии геймпада")
+               .add(IPC_STRUCT(stamp).title("Метка отправки"))
+               .add(IPC_INT(version).title("Версия раскладки").default_(1))
+               .add(IPC_STRINGS(buttons).title("Кнопки по номеру бита").element_default(""))
+               .add(IPC_STRINGS(axes).title("Оси по порядку").element_default(""))
+               ;
+        }
+    };
+
+    // Отсчет управления высокой частоты
+    struct ControlSample {
+        uint64_t timestamp;
+        float value[6];
+        ipc::Schema schema() {
+            return ipc::Schema(this).title("Отсчет управления")
+               .add(IPC_INT(timestamp).title("Время отсчета").unit("мкс").default_(0))
+               .add(IPC_REALS(value).title("Значения по степеням свободы").element_default(0.0))
+               ;
+        }
+    };
+
+    // Пакет последних отсчетов управления: типы и системы координат общие на пакет
+    struct ControlBundle {
+        Stamp stamp;
+        uint32_t sequence;
+        int count;
+        double time_limit;
+        int priority;
+        bool is_compensation;
+        int type[6];
+        int frame[6];
+        ControlSample samples[32];
+        ipc::Schema schema() {
+            return ipc::Schema(this).title("Пакет отсчетов управления")
+               .add(IPC_STRUCT(stamp).title("Метка отправки"))
+               .add(IPC_INT(sequence).title("Номер пакета").default_(0))
+               .add(IPC_INT(count).title("Число отсчетов").default_(0))
+               .add(IPC_REAL(time_limit).title("Лимит времени").unit("c").default_(0.0))
+               .add(IPC_INT(priority).title("Приоритет").default_(0))
+               .add(IPC_BOOL(is_compensation).title("Компенсирующие силы").default_(true))
+               .add(IPC_INTS(type).title("Тип управления").element_default(0))
+               .add(IPC_INTS(frame).title("Система координат").element_default(0))
+               .add(IPC_STRUCTS(samples).title("Отсчеты").element_title("Отсчет"))
+               ;
+        }
+    };
+
+    // Метка отправки motion::Control. Формат команды принадлежит модулю движения,
+    // поэтому метка уходит следом отдельным сообщением.
+    struct ControlStamp {
+        Stamp stamp;
+        uint32_t checksum;
+        ipc::Schema schema() {
+            return ipc::Schema(this).title("Метка команды движения")
+               .add(IPC_STRUCT(stamp).title("Метка отправки"))
+               .add(IPC_INT(checksum).title("Контрольная сумма команды").default_(0))
+               ;
+        }
+    };
+
+    // Подтверждение команды движения получателем: номер из метки команды
+    struct ControlAck {
+        Stamp stamp;
+        uint32_t sequence;
+        uint64_t sent;
+        ipc::Schema schema() {
+            return ipc::Schema(this).title("Подтверждение команды движения")
+               .add(IPC_STRUCT(stamp).title("Метка отправки"))
+               .add(IPC_INT(sequence).title("Номер подтвержденной команды").default_(0))
+               .add(IPC_INT(sent).title("Время отправки команды").unit("мкс").default_(0))
+               ;
+        }
+    };
+
+    // Передача: коэффициенты скорости по степеням свободы
+    struct SpeedGear {
+        double right;
+        double forward;
+        double up;
+        double yaw;
+        double pitch;
+        double roll;
+        ipc::Schema schema() {
+            return ipc::Schema(this).title("Передача")
+               .add(IPC_REAL(right).title("На восток").default_(1.0))
+               .add(IPC_REAL(forward).title("На север").default_(1.0))
+               .add(IPC_REAL(up).title("Вверх").default_(1.0))
+               .add(IPC_REAL(yaw).title("По курсу").default_(1.0))
+               .add(IPC_REAL(pitch).title("По дифференту").default_(1.0))
+               .add(IPC_REAL(roll).title("По крену").default_(1.0))
+               ;
+        }
+    };
+
     struct Init {
         double  state_timer;
         double  read_timer;
         double  send_timer;
+        bool    fixed_point;
+        double  deadzone;
+        bool    deadzone_adaptive;
+        double  deadzone_min;
+        double  deadzone_max;
+        double  deadzone_sigmas;
+        bool    prediction;
+        double  prediction_latency;
+        double  prediction_alpha;
+        double  prediction_beta;
+        int     gear_count;
+        int     gear_initial;
+        SpeedGear gears[8];
+        double  gamepad_keepalive;
+        bool    gamepad_state_compat;
+        bool    control_dedup;
+        double  control_tolerance;
+        double  control_keepalive_margin;
+        double  sample_rate;
+        int     bundle_size;
+        bool    udp_control;
+        bool    control_redundant;
+        ipc::String<40> udp_host;
+        int     udp_port;
+        int     critical_burst;
+        double  critical_retry;
+        int     critical_retries;
+        bool    critical_ack_work;
+        double  loop_timeout;
+        double  loop_tolerance;
+        bool    adapt_link;
+        double  send_timer_min;
+        double  send_timer_max;
+        double  time_limit_min;
+        double  time_limit_max;
+        int     queue_target;
 
         ipc::Schema schema() {
             return ipc::Schema(this).title("Настройки")
@@ -55,78 +222,433 @@ namespace Message {
                 .add(IPC_INT(read_timer).title("Период чтения данных")
                      .unit("c").default_(1.0))
                 .add(IPC_INT(send_timer).title("Период посылки данных")
-                     .unit("c").default_(0.5));
+                     .unit("c").default_(0.5))
+                .add(IPC_BOOL(fixed_point).title("Отображение осей")
+                     .false_(ipc::Ok, "Плавающая точка").true_(ipc::On, "Фиксированная точка")
+                     .default_(false))
+                .add(IPC_REAL(deadzone).title("Мертвая зона")
+                     .minimum(0.0).maximum(1.0).default_(0.2))
+                .add(IPC_BOOL(deadzone_adaptive).title("Подстройка мертвой зоны по шуму")
+                     .false_(ipc::Off, "Выключена").true_(ipc::On, "Включена")
+                     .default_(false))
+                .add(IPC_REAL(deadzone_min).title("Минимальная мертвая зона")
+                     .minimum(0.0).maximum(1.0).default_(0.03))
+                .add(IPC_REAL(deadzone_max).title("Максимальная мертвая зона")
+                     .minimum(0.0).maximum(1.0).default_(0.25))
+                .add(IPC_REAL(deadzone_sigmas).title("Запас мертвой зоны над шумом")
+                     .unit("СКО").default_(4.0))
+                .add(IPC_BOOL(prediction).title("Упреждение отклонения ручек")
+                     .false_(ipc::Off, "Выключено").true_(ipc::On, "Включено")
+                     .default_(false))
+                .add(IPC_REAL(prediction_latency).title("Время упреждения")
+                     .unit("c").minimum(0.0).maximum(1.0).default_(0.1))
+                .add(IPC_REAL(prediction_alpha).title("Коэффициент альфа предсказателя")
+                     .minimum(0.0).maximum(1.0).default_(0.5))
+                .add(IPC_REAL(prediction_beta).title("Коэффициент бета предсказателя")
+                     .minimum(0.0).maximum(1.0).default_(0.1))
+                .add(IPC_INT(gear_count).title("Число передач")
+                     .minimum(1).maximum(8).default_(1))
+                .add(IPC_INT(gear_initial).title("Начальная передача")
+                     .minimum(1).maximum(8).default_(1))
+                .add(IPC_STRUCTS(gears).title("Передачи")
+                     .element_title("Передача"))
+                .add(IPC_REAL(gamepad_keepalive).title("Повтор неизменного состояния геймпада")
+                     .unit("c").minimum(0.0).default_(1.0))
+                .add(IPC_BOOL(gamepad_state_compat).title("Прежнее сообщение состояния геймпада")
+                     .false_(ipc::Off, "Только телеметрия").true_(ipc::On, "Телеметрия и GamepadState")
+                     .default_(true))
+                .add(IPC_BOOL(control_dedup).title("Отсев повторных команд движения")
+                     .false_(ipc::Off, "Каждый такт").true_(ipc::On, "Только изменения и повтор")
+                     .default_(true))
+                .add(IPC_REAL(control_tolerance).title("Допуск совпадения команды")
+                     .minimum(0.0).default_(0.01))
+                .add(IPC_REAL(control_keepalive_margin).title("Запас повтора до лимита времени команды")
+                     .unit("c").minimum(0.0).default_(0.5))
+                .add(IPC_REAL(sample_rate).title("Частота отсчетов управления, 0 - без пакетов")
+                     .unit("Гц").minimum(0.0).maximum(1000.0).default_(0.0))
+                .add(IPC_INT(bundle_size).title("Отсчетов в пакете")
+                     .minimum(1).maximum(32).default_(8))
+                .add(IPC_BOOL(udp_control).title("Команды движения")
+                     .false_(ipc::Off, "По шине").true_(ipc::On, "Напрямую по UDP, шина - запасной путь")
+                     .default_(false))
+                .add(IPC_BOOL(control_redundant).title("Дублирование команд движения")
+                     .false_(ipc::Off, "Один путь").true_(ipc::On, "UDP и шина одновременно")
+                     .default_(false))
+                .add(IPC_STRING(udp_host).title("Адрес получателя UDP").default_("127.0.0.1"))
+                .add(IPC_INT(udp_port).title("Порт получателя UDP").minimum(1).maximum(65535).default_(20470))
+                .add(IPC_INT(critical_burst).title("Копий команды остановки сразу")
+                     .minimum(1).maximum(10).default_(3))
+                .add(IPC_REAL(critical_retry).title("Повтор остановки без подтверждения")
+                     .unit("c").minimum(0.01).default_(0.05))
+                .add(IPC_INT(critical_retries).title("Повторов остановки до отказа")
+                     .minimum(0).default_(20))
+                .add(IPC_BOOL(critical_ack_work).title("Подтверждение остановки")
+                     .false_(ipc::Off, "Только ControlAck").true_(ipc::On, "ControlAck или motion::Work")
+                     .default_(false))
+                .add(IPC_REAL(loop_timeout).title("Ожидание отклика сил на команду")
+                     .unit("c").minimum(0.1).default_(2.0))
+                .add(IPC_REAL(loop_tolerance).title("Изменение сил, считающееся откликом")
+                     .unit("Н").minimum(0.0).default_(0.01))
+                .add(IPC_BOOL(adapt_link).title("Подстройка под канал")
+                     .false_(ipc::Off, "Постоянные период и time_limit")
+                     .true_(ipc::On, "По RTT, потерям и очереди получателя")
+                     .default_(false))
+                .add(IPC_REAL(send_timer_min).title("Наименьший период посылки")
+                     .unit("c").minimum(0.001).default_(0.02))
+                .add(IPC_REAL(send_timer_max).title("Наибольший период посылки")
+                     .unit("c").minimum(0.001).default_(0.5))
+                .add(IPC_REAL(time_limit_min).title("Наименьший лимит времени команды")
+                     .unit("c").minimum(0.1).maximum(10.0).default_(0.5))
+                .add(IPC_REAL(time_limit_max).title("Наибольший лимит времени команды")
+                     .unit("c").minimum(0.1).maximum(10.0).default_(5.0))
+                .add(IPC_INT(queue_target).title("Допустимая очередь получателя")
+                     .minimum(0).default_(2));
         }
     };
 
-    struct CommandBinding {
+    // Описание команды: чем вызывается, что делает и с какими параметрами
+    struct CommandEntry {
         ipc::String<80> title;
+        ipc::String<15> trigger;
         ipc::String<15> binding;
+        ipc::String<15> action;
+        ipc::String<15> slot;
+        ipc::String<15> sample;
+        ipc::String<15> type;
+        ipc::String<15> frame;
+        ipc::String<15> layer;
+        ipc::String<15> target;
+        ipc::String<80> expression;
+        double value;
+        double gain;
+        double expo;
+        bool invert;
 
         ipc::Schema schema() {
             return ipc::Schema(this).title("Команда")
                 .add(IPC_STRING(title).title("Описание"))
-                .add(IPC_STRING(binding).title("Привязка"));
+                .add(IPC_STRING(trigger).title("Источник (button, axis)"))
+                .add(IPC_STRING(binding).title("Привязка"))
+                .add(IPC_STRING(action).title("Действие"))
+                .add(IPC_STRING(slot).title("Степень свободы (right, forward, up, yaw, pitch, roll)"))
+                .add(IPC_STRING(sample).title("Отсчет за период (last, mean, peak)")
+                     .default_("last"))
+                .add(IPC_STRING(type).title("Тип управления (force, velocity, position)")
+                     .default_("velocity"))
+                .add(IPC_STRING(frame).title("Система координат (absent, zero, seabed, ...)")
+                     .default_("absent"))
+                .add(IPC_STRING(layer).title("Слой (пусто - базовый)").default_(""))
+                .add(IPC_STRING(target).title("Переключаемый слой").default_(""))
+                .add(IPC_STRING(expression).title("Формула для formula").default_(""))
+                .add(IPC_REAL(value).title("Значение").default_(0.0))
+                .add(IPC_REAL(gain).title("Коэффициент").default_(1.0))
+                .add(IPC_REAL(expo).title("Доля кубической кривой").default_(0.0))
+                .add(IPC_BOOL(invert).title("Инверсия оси").default_(false));
         }
     };
 
-    struct ButtonBindings {
-        CommandBinding start_control;
-        CommandBinding stop_control;
-        CommandBinding set_min_speed;
-        CommandBinding set_slow_speed;
-        CommandBinding set_max_speed;
-        CommandBinding set_zero_speed;
+    // Слой привязок: целая таблица команд поверх базовой
+    struct LayerEntry {
+        ipc::String<15> name;
+        ipc::String<80> title;
 
         ipc::Schema schema() {
-            return ipc::Schema(this).title("Команды кнопок")
-                .add(IPC_STRUCT(start_control))
-                .add(IPC_STRUCT(stop_control))
-                .add(IPC_STRUCT(set_min_speed))
-                .add(IPC_STRUCT(set_slow_speed))
-                .add(IPC_STRUCT(set_max_speed))
-                .add(IPC_STRUCT(set_zero_speed))
-                ;
+            return ipc::Schema(this).title("Слой")
+                .add(IPC_STRING(name).title("Имя"))
+                .add(IPC_STRING(title).title("Описание"));
         }
     };
 
-    struct AxisBindings {
-        CommandBinding move_forward;
-        CommandBinding move_right;
+    struct GamepadBindings {
+        LayerEntry layers[7];
+        CommandEntry commands[48];
 
         ipc::Schema schema() {
-            return ipc::Schema(this).title("Команды осей")
-                .add(IPC_STRUCT(move_forward))
-                .add(IPC_STRUCT(move_right))
+            return ipc::Schema(this).title("")
+                .add(IPC_STRUCTS(layers).title("Слои")
+                     .element_title("Слой"))
+                .add(IPC_STRUCTS(commands).title("Команды")
+                     .element_title("Команда"))
                 ;
         }
     };
 
-    struct GamepadBindings {
-        AxisBindings axis_commands;
-        ButtonBindings button_commands;
+    // Оценка шума оси в покое
+    struct AxisNoise {
+        double drift;
+        double noise;
+        double deadzone;
+        ipc::Schema schema() {
+            return ipc::Schema(this).title("Шум оси")
+               .add(IPC_REAL(drift).title("Смещение центра").default_(0.0))
+               .add(IPC_REAL(noise).title("СКО шума").default_(0.0))
+               .add(IPC_REAL(deadzone).title("Мертвая зона").default_(0.0))
+               ;
+        }
+    };
 
+    // Качество упреждения оси
+    struct AxisPrediction {
+        double error;
+        double hold_error;
         ipc::Schema schema() {
-            return ipc::Schema(this).title("")
-                .add(IPC_STRUCT(axis_commands).title("Команды осей"))
-                .add(IPC_STRUCT(button_commands).title("Команды кнопок"))
-                ;
+            return ipc::Schema(this).title("Упреждение оси")
+               .add(IPC_REAL(error).title("СКО ошибки прогноза").default_(0.0))
+               .add(IPC_REAL(hold_error).title("СКО ошибки без прогноза").default_(0.0))
+               ;
+        }
+    };
+
+    // Профиль в хранилище: для кого и из каких файлов
+    struct ProfileEntry {
+        ipc::String<40> name;
+        ipc::String<40> pilot;
+        ipc::String<40> guid;
+        ipc::String<80> settings;
+        ipc::String<80> bindings;
+
+        ipc::Schema schema() {
+            return ipc::Schema(this).title("Профиль")
+                .add(IPC_STRING(name).title("Имя"))
+                .add(IPC_STRING(pilot).title("Пилот (пусто - любой)").default_(""))
+                .add(IPC_STRING(guid).title("GUID пульта (пусто - любой)").default_(""))
+                .add(IPC_STRING(settings).title("Файл настроек относительно load").default_(""))
+                .add(IPC_STRING(bindings).title("Файл привязок относительно load").default_(""));
+        }
+    };
+
+    struct Profiles {
+        ProfileEntry profiles[16];
+
+        ipc::Schema schema() {
+            return ipc::Schema(this).title("Профили")
+                .add(IPC_STRUCTS(profiles).title("Профили")
+                     .element_title("Профиль"));
+        }
+    };
+
+    // Выбор пилота оператором: профиль подбирается заново
+    struct Pilot {
+        ipc::String<40> name;
+        ipc::Schema schema() {
+            return ipc::Schema(this).title("Пилот")
+               .add(IPC_STRING(name).title("Имя пилота").default_(""))
+               ;
+        }
+    };
+
+    // Запрос перечитать настройки без перезапуска
+    struct Reload {
+        ipc::String<80> reason;
+        ipc::Schema schema() {
+            return ipc::Schema(this).title("Перечитать настройки")
+               .add(IPC_STRING(reason).title("Причина").default_(""))
+               ;
+        }
+    };
+
+    // Действующая конфигурация и последняя перезагрузка
+    struct ConfigState {
+        int version;
+        ipc::String<15> checksum;
+        int reloads;
+        int unchanged;
+        double latency;
+        double build_time;
+        ipc::Schema schema() {
+            return ipc::Schema(this).title("Конфигурация")
+               .add(IPC_INT(version).title("Версия").default_(0))
+               .add(IPC_STRING(checksum).title("Контрольная сумма").default_(""))
+               .add(IPC_INT(reloads).title("Применено перезагрузок").default_(0))
+               .add(IPC_INT(unchanged).title("Перечитано без изменений").default_(0))
+               .add(IPC_REAL(latency).title("Задержка перезагрузки").unit("c").default_(0.0))
+               .add(IPC_REAL(build_time).title("Сборка таблиц").unit("c").default_(0.0))
+               ;
+        }
+    };
+
+    // Отправки за последнюю минуту: ушло и сэкономлено
+    struct SendRate {
+        int sent;
+        int skipped;
+        double sent_bytes;
+        double skipped_bytes;
+        ipc::Schema schema() {
+            return ipc::Schema(this).title("Отправки за минуту")
+               .add(IPC_INT(sent).title("Отправлено сообщений").default_(0))
+               .add(IPC_INT(skipped).title("Пропущено сообщений").default_(0))
+               .add(IPC_REAL(sent_bytes).title("Отправлено").unit("байт").default_(0.0))
+               .add(IPC_REAL(skipped_bytes).title("Сэкономлено").unit("байт").default_(0.0))
+               ;
+        }
+    };
+
+    // Доставка одного потока по меткам отправки, доли - от ожидаемого числа сообщений
+    struct StreamStats {
+        int received;
+        int lost;
+        int duplicates;
+        int reordered;
+        int restarts;
+        double loss_rate;
+        double duplicate_rate;
+        double reorder_rate;
+        ipc::Schema schema() {
+            return ipc::Schema(this).title("Доставка потока")
+               .add(IPC_INT(received).title("Принято").default_(0))
+               .add(IPC_INT(lost).title("Потеряно").default_(0))
+               .add(IPC_INT(duplicates).title("Повторов").default_(0))
+               .add(IPC_INT(reordered).title("Не по порядку").default_(0))
+               .add(IPC_INT(restarts).title("Перезапусков отправителя").default_(0))
+               .add(IPC_REAL(loss_rate).title("Доля потерь").default_(0.0))
+               .add(IPC_REAL(duplicate_rate).title("Доля повторов").default_(0.0))
+               .add(IPC_REAL(reorder_rate).title("Доля перестановок").default_(0.0))
+               ;
+        }
+    };
+
+    // Диагностика доставки: публикует получатель команд драйвера
+    struct LinkDiagnostics {
+        Stamp stamp;
+        StreamStats control;
+        StreamStats bundle;
+        StreamStats state;
+        StreamStats udp;
+        StreamStats delivered;
+        int queue_depth;
+        ipc::Schema schema() {
+            return ipc::Schema(this).title("Диагностика доставки")
+               .add(IPC_STRUCT(stamp).title("Метка отправки"))
+               .add(IPC_STRUCT(control).title("Команды движения"))
+               .add(IPC_STRUCT(bundle).title("Пакеты отсчетов"))
+               .add(IPC_STRUCT(state).title("Состояние драйвера"))
+               .add(IPC_STRUCT(udp).title("Команды движения по UDP"))
+               .add(IPC_STRUCT(delivered).title("Команды движения после сведения путей"))
+               .add(IPC_INT(queue_depth).title("Очередь команд у получателя").default_(0))
+               ;
+        }
+    };
+
+    // Доставка команд остановки с подтверждением
+    struct CriticalState {
+        int sent;
+        int acknowledged;
+        int superseded;
+        int failed;
+        int last_retries;
+        double last_ack_time;
+        double max_ack_time;
+        ipc::Schema schema() {
+            return ipc::Schema(this).title("Команды остановки")
+               .add(IPC_INT(sent).title("Отправлено").default_(0))
+               .add(IPC_INT(acknowledged).title("Подтверждено").default_(0))
+               .add(IPC_INT(superseded).title("Отменено новой командой").default_(0))
+               .add(IPC_INT(failed).title("Без подтверждения").default_(0))
+               .add(IPC_INT(last_retries).title("Повторов последней").default_(0))
+               .add(IPC_REAL(last_ack_time).title("Подтверждение последней").unit("c").default_(0.0))
+               .add(IPC_REAL(max_ack_time).title("Наибольшее время подтверждения").unit("c").default_(0.0))
+               ;
+        }
+    };
+
+    // Задержка от команды до изменения сил ДРК, перцентили по гистограмме
+    struct LoopLatencyState {
+        int samples;
+        int timeouts;
+        double mean;
+        double p50;
+        double p90;
+        double p99;
+        double max;
+        ipc::Schema schema() {
+            return ipc::Schema(this).title("Задержка контура")
+               .add(IPC_INT(samples).title("Замеров").default_(0))
+               .add(IPC_INT(timeouts).title("Без отклика").default_(0))
+               .add(IPC_REAL(mean).title("Среднее").unit("мс").default_(0.0))
+               .add(IPC_REAL(p50).title("50%").unit("мс").default_(0.0))
+               .add(IPC_REAL(p90).title("90%").unit("мс").default_(0.0))
+               .add(IPC_REAL(p99).title("99%").unit("мс").default_(0.0))
+               .add(IPC_REAL(max).title("Наибольшая").unit("мс").default_(0.0))
+               ;
+        }
+    };
+
+    // Подстройка периода посылки и time_limit под канал
+    struct LinkAdaptState {
+        double interval;
+        double time_limit;
+        double rtt;
+        double loss;
+        int queue;
+        bool congested;
+        ipc::Schema schema() {
+            return ipc::Schema(this).title("Подстройка под канал")
+               .add(IPC_REAL(interval).title("Период посылки").unit("c").default_(0.0))
+               .add(IPC_REAL(time_limit).title("Лимит времени команды").unit("c").default_(0.0))
+               .add(IPC_REAL(rtt).title("Сглаженный RTT").unit("мс").default_(0.0))
+               .add(IPC_REAL(loss).title("Потери за период").default_(0.0))
+               .add(IPC_INT(queue).title("Очередь получателя").default_(0))
+               .add(IPC_BOOL(congested).title("Канал")
+                    .false_(ipc::Ok, "Свободен").true_(ipc::Warning, "Перегружен").default_(false))
+               ;
         }
     };
 
     // Состояние программы //
     struct State {
+        Stamp stamp;
         bool send_regime;
+        int gear;
+        int macro_recording;
+        int macro_playing;
+        ipc::String<15> layer;
+        ipc::String<40> profile;
+        ipc::String<40> pilot;
+        ipc::String<40> device;
+        ConfigState config;
+        SendRate gamepad_state;
+        SendRate gamepad_telemetry;
+        SendRate control;
+        SendRate control_bundle;
+        SendRate control_udp;
+        LinkDiagnostics link;
+        CriticalState critical;
+        LoopLatencyState loop;
+        LinkAdaptState adapt;
         Init settings;
         GamepadBindings bindings;
+        AxisNoise axesNoise[4];
+        AxisPrediction axesPrediction[4];
         ipc::Schema schema() {
             return ipc::Schema(this).title("Состояние")
+                .add(IPC_STRUCT(stamp).title("Метка отправки"))
                 .add(IPC_BOOL(send_regime).title("Режим работы")
                     .false_(ipc::Ok, "Получатель").true_(ipc::On, "Отправитель"))
+                .add(IPC_INT(gear).title("Текущая передача").default_(1))
+                .add(IPC_INT(macro_recording).title("Записывается макрос").default_(0))
+                .add(IPC_INT(macro_playing).title("Воспроизводится макрос").default_(0))
+                .add(IPC_STRING(layer).title("Активный слой").default_("base"))
+                .add(IPC_STRING(profile).title("Профиль").default_(""))
+                .add(IPC_STRING(pilot).title("Пилот").default_(""))
+                .add(IPC_STRING(device).title("GUID пульта").default_(""))
+                .add(IPC_STRUCT(config).title("Конфигурация"))
+                .add(IPC_STRUCT(gamepad_state).title("Публикация состояния геймпада"))
+                .add(IPC_STRUCT(gamepad_telemetry).title("Публикация телеметрии геймпада"))
+                .add(IPC_STRUCT(control).title("Отправка команд движения (пропущено - отсеяно)"))
+                .add(IPC_STRUCT(control_bundle).title("Отправка пакетов отсчетов управления"))
+                .add(IPC_STRUCT(control_udp).title("Отправка команд движения по UDP (пропущено - ошибки сокета)"))
+                .add(IPC_STRUCT(link).title("Доставка по данным получателя"))
+                .add(IPC_STRUCT(critical).title("Команды остановки"))
+                .add(IPC_STRUCT(loop).title("Задержка от команды до сил"))
+                .add(IPC_STRUCT(adapt).title("Подстройка под канал"))
                 .add(IPC_STRUCT(settings)
                     .title("Настройки"))
                 .add(IPC_STRUCT(bindings)
                     .title("Текущие настройки управления"))
+                .add(IPC_STRUCTS(axesNoise).title("Шум осей")
+                    .element_title("Шум оси"))
+                .add(IPC_STRUCTS(axesPrediction).title("Упреждение осей")
+                    .element_title("Упреждение оси"))
                 ;
         }
     };
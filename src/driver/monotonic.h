@@ -0,0 +1,12 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+// Монотонное время для меток в сообщениях: не зависит от перевода часов,
+// у процессов одной машины общее начало отсчета
+inline uint64_t MonotonicMicroseconds()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
@@ -0,0 +1,80 @@
+#include "noiseestimator.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "fixedmapping.h"
+
+void NoiseEstimator::Configure(const DeadzoneSettings& settings)
+{
+    this->settings = settings;
+    if (this->settings.minimum > this->settings.maximum) {
+        std::swap(this->settings.minimum, this->settings.maximum);
+    }
+    Reset();
+}
+
+void NoiseEstimator::Reset()
+{
+    samples = 0;
+    mean = 0;
+    variance = 0;
+    stale = 0;
+    deadzone = DeadzoneToQ15(static_cast<float>(settings.adaptive ? settings.maximum : settings.deadzone));
+}
+
+void NoiseEstimator::Update(int32_t raw)
+{
+    if (!settings.adaptive) {
+        return;
+    }
+
+    // Отклонение за верхнюю границу - ручку двигают, это не шум
+    double x = static_cast<double>(raw) / Q15One;
+    if (std::fabs(x) > settings.maximum) {
+        return;
+    }
+
+    // Вне полосы шума - удержание ручки, оно не смещает центр. Если такие отсчеты
+    // ближе к нулю, чем среднее, среднее набрано при отклоненной ручке: начать заново
+    if (samples >= WarmupSamples) {
+        double band = std::max(settings.minimum, settings.sigmas * std::sqrt(variance));
+        if (std::fabs(x - mean) > band) {
+            stale = std::fabs(x) < std::fabs(mean) ? stale + 1 : 0;
+            if (stale >= WarmupSamples) {
+                Reset();
+            }
+            return;
+        }
+        stale = 0;
+    }
+
+    samples++;
+    double alpha = std::max(1.0 / samples, 1.0 / WindowSamples);
+    double delta = x - mean;
+    mean += alpha * delta;
+    variance = (1.0 - alpha) * (variance + alpha * delta * delta);
+
+    if (samples < WarmupSamples) {
+        return;
+    }
+
+    double value = std::fabs(mean) + settings.sigmas * std::sqrt(variance);
+    value = std::min(std::max(value, settings.minimum), settings.maximum);
+    deadzone = DeadzoneToQ15(static_cast<float>(value));
+}
+
+double NoiseEstimator::Drift() const
+{
+    return mean;
+}
+
+double NoiseEstimator::Noise() const
+{
+    return std::sqrt(variance);
+}
+
+int16_t NoiseEstimator::Deadzone() const
+{
+    return deadzone;
+}
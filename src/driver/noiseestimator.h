@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+
+struct DeadzoneSettings
+{
+    bool   adaptive = false;
+    double deadzone = 0.2;   // Постоянная мертвая зона, если адаптация выключена
+    double minimum = 0.03;   // Границы адаптивной мертвой зоны
+    double maximum = 0.25;
+    double sigmas = 4.0;     // Сколько СКО шума укладывается в мертвую зону
+};
+
+// Оценка шума и смещения центра одной оси, пока ручка в покое.
+// Экспоненциальное среднее и дисперсия, память постоянная. Покой - отсчет
+// не дальше maximum от нуля и в полосе шума вокруг среднего; среднее,
+// набранное при отклоненной ручке, сбрасывается, когда ручка вернулась к нулю.
+class NoiseEstimator
+{
+public:
+    void Configure(const DeadzoneSettings& settings);
+    void Reset();
+
+    // Отсчет оси в единицах Q15, раз в такт управления
+    void Update(int32_t raw);
+
+    double Drift() const;       // Смещение центра, доли хода
+    double Noise() const;       // СКО шума, доли хода
+    int16_t Deadzone() const;   // Q15
+
+private:
+    static const int WarmupSamples = 32;
+    static const int WindowSamples = 256;
+
+    DeadzoneSettings settings;
+    int64_t samples = 0;
+    double mean = 0;
+    double variance = 0;
+    int stale = 0;              // Отсчетов подряд вне полосы, но ближе к нулю, чем среднее
+    int16_t deadzone = 0;
+};
@@ -0,0 +1,99 @@
+#include "predictor.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "fixedmapping.h"
+
+void AxisPredictor::Configure(const PredictorSettings& settings)
+{
+    this->settings = settings;
+    SetLatency(settings.latency);
+    Reset();
+}
+
+void AxisPredictor::Reset()
+{
+    initialized = false;
+    position = 0;
+    velocity = 0;
+    head = 0;
+    count = 0;
+    scored = 0;
+    errorSquare = 0;
+    holdErrorSquare = 0;
+}
+
+void AxisPredictor::SetLatency(double seconds)
+{
+    latencyMs = seconds > 0 ? static_cast<uint32_t>(seconds * 1000 + 0.5) : 0;
+}
+
+int32_t AxisPredictor::Update(int32_t raw, uint32_t time, int32_t deadzone)
+{
+    double x = static_cast<double>(raw);
+    Score(x, time);
+
+    bool released = std::abs(raw) < deadzone;
+    if (!initialized || time <= lastTime || released) {
+        initialized = true;
+        lastTime = time;
+        position = x;
+        velocity = 0;
+    }
+    else {
+        double dt = time - lastTime;
+        double estimate = position + velocity * dt;
+        double residual = x - estimate;
+        position = estimate + settings.alpha * residual;
+        velocity += settings.beta * residual / dt;
+        lastTime = time;
+    }
+
+    double predicted = position + velocity * latencyMs;
+    predicted = std::min(std::max(predicted, -static_cast<double>(Q15One)), static_cast<double>(Q15One));
+    // Экстраполяция возврата ручки не должна проскочить ноль: это была бы обратная тяга
+    if (released || predicted * x <= 0) {
+        predicted = 0;
+    }
+
+    // Переполнение очереди - теряем самый старый прогноз, а не память
+    if (count == PendingCapacity) {
+        head = (head + 1) % PendingCapacity;
+        count--;
+    }
+    Pending& entry = pending[(head + count) % PendingCapacity];
+    entry.time = time + latencyMs;
+    entry.predicted = predicted;
+    entry.held = x;
+    count++;
+
+    return static_cast<int32_t>(std::floor(predicted + 0.5));
+}
+
+void AxisPredictor::Score(double actual, uint32_t time)
+{
+    while (count > 0 && pending[head].time <= time) {
+        const Pending& entry = pending[head];
+        double error = (entry.predicted - actual) / Q15One;
+        double holdError = (entry.held - actual) / Q15One;
+
+        scored++;
+        double alpha = std::max(1.0 / scored, 1.0 / ErrorWindow);
+        errorSquare += alpha * (error * error - errorSquare);
+        holdErrorSquare += alpha * (holdError * holdError - holdErrorSquare);
+
+        head = (head + 1) % PendingCapacity;
+        count--;
+    }
+}
+
+double AxisPredictor::PredictionError() const
+{
+    return std::sqrt(errorSquare);
+}
+
+double AxisPredictor::HoldError() const
+{
+    return std::sqrt(holdErrorSquare);
+}
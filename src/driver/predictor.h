@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+
+struct PredictorSettings
+{
+    bool   enabled = false;
+    double latency = 0.1;    // Упреждение, с
+    double alpha = 0.5;      // Коэффициенты альфа-бета фильтра
+    double beta = 0.1;
+};
+
+// Альфа-бета предсказатель одной оси: экстраполирует отсчет на время задержки
+// до движителей. Хранит ограниченную очередь сделанных прогнозов, чтобы
+// сравнить их с фактическими отсчетами, когда те наступят.
+class AxisPredictor
+{
+public:
+    void Configure(const PredictorSettings& settings);
+    void Reset();
+    void SetLatency(double seconds);
+
+    // Отсчет Q15 в момент time (мс), возвращает прогноз Q15 на time + latency.
+    // Отсчет в мертвой зоне (deadzone, Q15) - ручка отпущена: прогноз 0, скорость
+    // сбрасывается. Прогноз не меняет знак относительно отсчета.
+    int32_t Update(int32_t raw, uint32_t time, int32_t deadzone = 0);
+
+    double PredictionError() const;   // СКО ошибки прогноза, доли хода
+    double HoldError() const;         // СКО ошибки без прогноза (удержание отсчета)
+
+private:
+    struct Pending {
+        uint32_t time;
+        double predicted;
+        double held;
+    };
+
+    static const int PendingCapacity = 32;
+    static const int ErrorWindow = 256;
+
+    void Score(double actual, uint32_t time);
+
+    PredictorSettings settings;
+    uint32_t latencyMs = 0;
+
+    bool initialized = false;
+    uint32_t lastTime = 0;
+    double position = 0;
+    double velocity = 0;     // Q15 за мс
+
+    Pending pending[PendingCapacity];
+    int head = 0;
+    int count = 0;
+
+    int64_t scored = 0;
+    double errorSquare = 0;
+    double holdErrorSquare = 0;
+};
@@ -0,0 +1,162 @@
+#include "profilestore.h"
+
+#include <cstdio>
+#include <cstring>
+#include <sys/stat.h>
+
+static const char ProfileCacheMagic[4] = {'A', 'U', 'V', 'P'};
+static const uint32_t ProfileCacheVersion = 1;
+static const char* const ProfileCacheName = "/Profiles--cache.bin";
+
+static time_t ModificationTime(const std::string& path)
+{
+    struct stat info;
+    return stat(path.c_str(), &info) == 0 ? info.st_mtime : 0;
+}
+
+// Разбор одного JSON-файла в структуру сообщения по ее схеме
+template <typename T>
+static bool ParseFile(const std::string& path, const char* name, T& data)
+{
+    ipc::Message message(name, &data, sizeof(data));
+    message.schema(data.schema());
+    message.load_from_default();
+    return path.empty() || message.load_from_file(path);
+}
+
+bool ProfileStore::Load(const std::string& loadPath, const Message::Profiles& index)
+{
+    profiles.clear();
+    fromCache = false;
+
+    std::vector<std::string> sources(1, loadPath + "/Message--Profiles.json");
+    int count = 0;
+    for (const auto& entry : index.profiles) {
+        if (entry.name.to_std_string().empty()) {
+            break;
+        }
+        count++;
+        if (!entry.settings.to_std_string().empty()) {
+            sources.push_back(loadPath + "/" + entry.settings.to_std_string());
+        }
+        if (!entry.bindings.to_std_string().empty()) {
+            sources.push_back(loadPath + "/" + entry.bindings.to_std_string());
+        }
+    }
+    if (count == 0) {
+        return false;
+    }
+
+    time_t newest = 0;
+    for (const auto& source : sources) {
+        time_t modified = ModificationTime(source);
+        newest = modified > newest ? modified : newest;
+    }
+
+    const std::string cachePath = loadPath + ProfileCacheName;
+    if (ReadCache(cachePath, newest)) {
+        fromCache = true;
+        return true;
+    }
+
+    profiles.resize(count);
+    int loaded = 0;
+    for (int i = 0; i < count; i++) {
+        const Message::ProfileEntry& entry = index.profiles[i];
+        Profile& profile = profiles[loaded];
+        profile.name = entry.name.to_std_string();
+        profile.pilot = entry.pilot.to_std_string();
+        profile.guid = entry.guid.to_std_string();
+
+        std::string settings = entry.settings.to_std_string();
+        std::string bindings = entry.bindings.to_std_string();
+        if (!ParseFile(settings.empty() ? settings : loadPath + "/" + settings, "Message::Init", profile.settings)
+                || !ParseFile(bindings.empty() ? bindings : loadPath + "/" + bindings, "Message::GamepadBindings",
+                              profile.bindings)) {
+            continue;
+        }
+        loaded++;
+    }
+    profiles.resize(loaded);
+
+    WriteCache(cachePath);
+    return loaded > 0;
+}
+
+int ProfileStore::Select(const std::string& pilot, const std::string& guid) const
+{
+    int best = -1;
+    int bestScore = -1;
+    for (int i = 0; i < Count(); i++) {
+        std::string profilePilot = profiles[i].pilot.to_std_string();
+        std::string profileGuid = profiles[i].guid.to_std_string();
+        if ((!profilePilot.empty() && profilePilot != pilot) || (!profileGuid.empty() && profileGuid != guid)) {
+            continue;
+        }
+        int score = (profileGuid.empty() ? 0 : 2) + (profilePilot.empty() ? 0 : 1);
+        if (score > bestScore) {
+            best = i;
+            bestScore = score;
+        }
+    }
+    return best;
+}
+
+int ProfileStore::Count() const
+{
+    return static_cast<int>(profiles.size());
+}
+
+const Profile& ProfileStore::Get(int index) const
+{
+    return profiles[index];
+}
+
+bool ProfileStore::FromCache() const
+{
+    return fromCache;
+}
+
+// Заголовок кэша: сигнатура, версия, размеры структур (меняются вместе со схемой), число профилей.
+// Время изменения с точностью до секунды: кэш той же секунды, что и правка, считается устаревшим
+bool ProfileStore::ReadCache(const std::string& path, time_t newestSource)
+{
+    if (ModificationTime(path) <= newestSource) {
+        return false;
+    }
+    FILE* file = fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        return false;
+    }
+    char magic[4];
+    uint32_t header[3];
+    bool ok = fread(magic, sizeof(magic), 1, file) == 1
+           && memcmp(magic, ProfileCacheMagic, sizeof(magic)) == 0
+           && fread(header, sizeof(header), 1, file) == 1
+           && header[0] == ProfileCacheVersion
+           && header[1] == sizeof(Profile)
+           && header[2] <= sizeof(Message::Profiles::profiles) / sizeof(Message::ProfileEntry);
+    if (ok) {
+        profiles.resize(header[2]);
+        ok = header[2] > 0 && fread(profiles.data(), sizeof(Profile), header[2], file) == header[2];
+    }
+    fclose(file);
+    if (!ok) {
+        profiles.clear();
+    }
+    return ok;
+}
+
+bool ProfileStore::WriteCache(const std::string& path) const
+{
+    FILE* file = fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+        return false;
+    }
+    uint32_t header[3] = {ProfileCacheVersion, sizeof(Profile), static_cast<uint32_t>(profiles.size())};
+    bool ok = fwrite(ProfileCacheMagic, sizeof(ProfileCacheMagic), 1, file) == 1
+           && fwrite(header, sizeof(header), 1, file) == 1
+           && fwrite(profiles.data(), sizeof(Profile), profiles.size(), file) == profiles.size();
+    fclose(file);
+    return ok;
+}
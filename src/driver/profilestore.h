@@ -0,0 +1,43 @@
+#pragma once
+
+#include <ctime>
+#include <string>
+#include <vector>
+
+#include "messages.h"
+
+// Профиль: полный набор настроек и привязок для пилота и/или модели пульта
+struct Profile
+{
+    ipc::String<40> name;
+    ipc::String<40> pilot;          // Пусто - любой пилот
+    ipc::String<40> guid;           // Пусто - любой пульт
+    Message::Init settings;
+    Message::GamepadBindings bindings;
+};
+
+// Хранилище профилей из Message--Profiles.json. JSON разбирается один раз,
+// результат сохраняется в двоичный кэш; пока кэш новее всех исходных файлов,
+// профили читаются из него без разбора. Профили не меняются после загрузки,
+// указатели на них остаются действительными.
+class ProfileStore
+{
+public:
+    // Возвращает false, если ни одного профиля не загружено
+    bool Load(const std::string& loadPath, const Message::Profiles& index);
+
+    // Лучший профиль для пилота и пульта или -1: совпадение пульта важнее пилота,
+    // непустые поля профиля должны совпасть
+    int Select(const std::string& pilot, const std::string& guid) const;
+
+    int Count() const;
+    const Profile& Get(int index) const;
+    bool FromCache() const;
+
+private:
+    bool ReadCache(const std::string& path, time_t newestSource);
+    bool WriteCache(const std::string& path) const;
+
+    std::vector<Profile> profiles;
+    bool fromCache = false;
+};
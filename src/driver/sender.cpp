@@ -14,18 +14,42 @@ void Sender<Message::GamepadState>::Initialize() {
 }
 
 template<>
-void Sender<Message::State>::Initialize() {
-    ipc::Loader<Message::Init> init(*core);
-    ipc::Loader<Message::GamepadBindings> gamepadBindings(*core);
+void Sender<Message::GamepadLayout>::Initialize() {
+    sender->_.version = 1;
+    for (int i = 0; i < Gamepad::ButtonCount; i++) {
+        sender->_.buttons[i] = SDL_GameControllerGetStringForButton(SDL_GameControllerButton(i));
+    }
+    for (int i = 0; i < SDL_CONTROLLER_AXIS_MAX; i++) {
+        sender->_.axes[i] = SDL_GameControllerGetStringForAxis(SDL_GameControllerAxis(i));
+    }
+}
 
-    sender->_.settings = init._;
-    sender->_.bindings = gamepadBindings._;
+// Настройки и привязки заполняет ConfigReloader при загрузке и перезагрузке
+template<>
+void Sender<Message::State>::Initialize() {
     sender->_.send_regime = true;
 }
 
+// Пульт - источник телекоманд: КАС (Alarm) и выше перебивают его.
+// Компенсирующие силы остаются по схеме
 template<>
 void Sender<motion::Control>::Initialize() {
-    sender->_.is_compensation = false;
-    sender->_.priority = motion::Priority::Highest;
+    sender->_.priority = motion::Priority::Telecommand;
     sender->_.time_limit = 2;
 }
+
+template<>
+void Sender<motion::Control>::StampData() {
+}
+
+template<>
+void Sender<Message::GamepadTelemetry>::StampData() {
+}
+
+template<>
+void Sender<Message::GamepadState>::StampData() {
+}
+
+template<>
+void Sender<Message::ControlStamp>::StampData() {
+}
@@ -2,6 +2,7 @@
 
 #include "ipc.h"
 #include "messages.h"
+#include "monotonic.h"
 #include "motion.h"
 
 template <typename LogType>
@@ -11,15 +12,34 @@ public:
     Sender(ipc::Core*);
     LogType& GetData();
     ~Sender();
-    void Send() const;
+    void Send();
 
     void Initialize();
 
 private:
+    void StampData();
+
     ipc::Sender<LogType> *sender;
     ipc::Core* core;
+    uint32_t sequence = 0;
 };
 
+// Формат motion::Control принадлежит модулю движения, метка уходит в Message::ControlStamp
+template<>
+void Sender<motion::Control>::StampData();
+
+// Номер команды общий для шины и UDP, метку ставит Application
+template<>
+void Sender<Message::ControlStamp>::StampData();
+
+// Телеметрия несет собственные номер и время отсчета
+template<>
+void Sender<Message::GamepadTelemetry>::StampData();
+
+// Прежнее сообщение для совместимости с существующими приемниками, его формат не меняется
+template<>
+void Sender<Message::GamepadState>::StampData();
+
 template<typename LogType>
 Sender<LogType>::Sender(ipc::Core* core) {
     sender = new ipc::Sender<LogType>(*core);
@@ -41,8 +61,17 @@ LogType& Sender<LogType>::GetData()
 }
 
 template<typename LogType>
-void Sender<LogType>::Send() const
+void Sender<LogType>::Send()
 {
+    StampData();
     sender->send();
 }
 
+// Номер растет с каждой отправкой, время - монотонное, общее для процессов машины
+template<typename LogType>
+void Sender<LogType>::StampData()
+{
+    sender->_.stamp.sequence = ++sequence;
+    sender->_.stamp.timestamp = MonotonicMicroseconds();
+}
+
@@ -0,0 +1,76 @@
+#include "sendstats.h"
+
+void SendStats::Reset()
+{
+    for (auto& bucket : buckets) {
+        bucket = Bucket();
+    }
+}
+
+void SendStats::Sent(uint32_t now, size_t bytes)
+{
+    Bucket& bucket = At(now);
+    bucket.sent++;
+    bucket.sentBytes += bytes;
+}
+
+void SendStats::Skipped(uint32_t now, size_t bytes)
+{
+    Bucket& bucket = At(now);
+    bucket.skipped++;
+    bucket.skippedBytes += bytes;
+}
+
+// Корзина текущей секунды; устаревшая обнуляется при первом обращении
+SendStats::Bucket& SendStats::At(uint32_t now)
+{
+    uint32_t second = now / 1000 + 1;
+    Bucket& bucket = buckets[second % WindowSeconds];
+    if (bucket.second != second) {
+        bucket = Bucket();
+        bucket.second = second;
+    }
+    return bucket;
+}
+
+bool SendStats::InWindow(const Bucket& bucket, uint32_t now) const
+{
+    uint32_t second = now / 1000 + 1;
+    return bucket.second != 0 && second - bucket.second < static_cast<uint32_t>(WindowSeconds);
+}
+
+uint32_t SendStats::SentMessages(uint32_t now) const
+{
+    uint32_t sum = 0;
+    for (const auto& bucket : buckets) {
+        sum += InWindow(bucket, now) ? bucket.sent : 0;
+    }
+    return sum;
+}
+
+uint32_t SendStats::SkippedMessages(uint32_t now) const
+{
+    uint32_t sum = 0;
+    for (const auto& bucket : buckets) {
+        sum += InWindow(bucket, now) ? bucket.skipped : 0;
+    }
+    return sum;
+}
+
+uint64_t SendStats::SentBytes(uint32_t now) const
+{
+    uint64_t sum = 0;
+    for (const auto& bucket : buckets) {
+        sum += InWindow(bucket, now) ? bucket.sentBytes : 0;
+    }
+    return sum;
+}
+
+uint64_t SendStats::SkippedBytes(uint32_t now) const
+{
+    uint64_t sum = 0;
+    for (const auto& bucket : buckets) {
+        sum += InWindow(bucket, now) ? bucket.skippedBytes : 0;
+    }
+    return sum;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Отправленные и пропущенные сообщения за скользящую минуту.
+// Кольцо из секундных корзин: память постоянна, учет без выделений.
+class SendStats
+{
+public:
+    static const int WindowSeconds = 60;
+
+    void Reset();
+    void Sent(uint32_t now, size_t bytes);
+    void Skipped(uint32_t now, size_t bytes);
+
+    // Суммы за последнюю минуту на момент now, мс
+    uint32_t SentMessages(uint32_t now) const;
+    uint32_t SkippedMessages(uint32_t now) const;
+    uint64_t SentBytes(uint32_t now) const;
+    uint64_t SkippedBytes(uint32_t now) const;
+
+private:
+    struct Bucket
+    {
+        uint32_t second;
+        uint32_t sent;
+        uint32_t skipped;
+        uint64_t sentBytes;
+        uint64_t skippedBytes;
+    };
+
+    Bucket& At(uint32_t now);
+    bool InWindow(const Bucket& bucket, uint32_t now) const;
+
+    Bucket buckets[WindowSeconds] = {};
+};
@@ -0,0 +1,122 @@
+#include "sequencetracker.h"
+
+void SequenceTracker::Reset()
+{
+    *this = SequenceTracker();
+}
+
+void SequenceTracker::Start(uint32_t sequence, uint64_t timestamp)
+{
+    started = true;
+    first = sequence;
+    highest = sequence;
+    highestTimestamp = timestamp;
+    seen = 1;
+}
+
+bool SequenceTracker::Receive(uint32_t sequence, uint64_t timestamp)
+{
+    received++;
+    if (!started) {
+        Start(sequence, timestamp);
+        return true;
+    }
+
+    // Разность по модулю 2^32 переживает переполнение номера
+    int32_t ahead = static_cast<int32_t>(sequence - highest);
+    if (ahead > 0) {
+        lost += static_cast<uint32_t>(ahead - 1);
+        seen = ahead < Window ? (seen << ahead) | 1 : 1;
+        highest = sequence;
+        highestTimestamp = timestamp;
+        return true;
+    }
+
+    if (timestamp > highestTimestamp) {
+        expected += highest - first + 1;
+        restarts++;
+        Start(sequence, timestamp);
+        return true;
+    }
+
+    uint32_t behind = static_cast<uint32_t>(-ahead);
+    if (behind >= static_cast<uint32_t>(Window)) {
+        // За окном повтор не отличить от опоздания, считаем опозданием
+        reordered++;
+        return false;
+    }
+    uint64_t bit = static_cast<uint64_t>(1) << behind;
+    if (seen & bit) {
+        duplicates++;
+        return false;
+    }
+    seen |= bit;
+    reordered++;
+    if (lost > 0) {
+        lost--;
+    }
+    return true;
+}
+
+bool SequenceTracker::Receive(const Message::Stamp& stamp)
+{
+    return Receive(stamp.sequence, stamp.timestamp);
+}
+
+uint32_t SequenceTracker::Received() const
+{
+    return received;
+}
+
+uint32_t SequenceTracker::Lost() const
+{
+    return lost;
+}
+
+uint32_t SequenceTracker::Duplicates() const
+{
+    return duplicates;
+}
+
+uint32_t SequenceTracker::Reordered() const
+{
+    return reordered;
+}
+
+uint32_t SequenceTracker::Restarts() const
+{
+    return restarts;
+}
+
+double SequenceTracker::Rate(uint32_t count) const
+{
+    uint32_t total = expected + (started ? highest - first + 1 : 0);
+    return total > 0 ? static_cast<double>(count) / total : 0.0;
+}
+
+double SequenceTracker::LossRate() const
+{
+    return Rate(lost);
+}
+
+double SequenceTracker::DuplicateRate() const
+{
+    return Rate(duplicates);
+}
+
+double SequenceTracker::ReorderRate() const
+{
+    return Rate(reordered);
+}
+
+void SequenceTracker::Fill(Message::StreamStats& stats) const
+{
+    stats.received       = static_cast<int>(received);
+    stats.lost           = static_cast<int>(lost);
+    stats.duplicates     = static_cast<int>(duplicates);
+    stats.reordered      = static_cast<int>(reordered);
+    stats.restarts       = static_cast<int>(restarts);
+    stats.loss_rate      = LossRate();
+    stats.duplicate_rate = DuplicateRate();
+    stats.reorder_rate   = ReorderRate();
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+
+#include "messages.h"
+
+// Учет доставки одного потока по меткам отправки в постоянной памяти.
+// Окно из 64 последних номеров отличает повтор от опоздавшего сообщения;
+// пропуск номера сначала считается потерей и списывается, если сообщение пришло позже.
+// Номер меньше уже принятого при более позднем времени отправки - перезапуск отправителя.
+class SequenceTracker
+{
+public:
+    static const int Window = 64;
+
+    void Reset();
+    // true - первая копия номера; повтор и опоздание за окно - false
+    bool Receive(uint32_t sequence, uint64_t timestamp);
+    bool Receive(const Message::Stamp& stamp);
+
+    uint32_t Received() const;
+    uint32_t Lost() const;
+    uint32_t Duplicates() const;
+    uint32_t Reordered() const;
+    uint32_t Restarts() const;
+
+    // Доли от ожидаемого числа сообщений: от первого до последнего номера каждого запуска
+    double LossRate() const;
+    double DuplicateRate() const;
+    double ReorderRate() const;
+
+    void Fill(Message::StreamStats& stats) const;
+
+private:
+    void Start(uint32_t sequence, uint64_t timestamp);
+    double Rate(uint32_t count) const;
+
+    bool started = false;
+    uint32_t highest = 0;
+    uint64_t highestTimestamp = 0;
+    uint64_t seen = 0;                // Бит i - принят номер highest - i
+    uint32_t expected = 0;            // Номеров в завершенных запусках
+    uint32_t first = 0;               // Первый номер текущего запуска
+
+    uint32_t received = 0;
+    uint32_t lost = 0;
+    uint32_t duplicates = 0;
+    uint32_t reordered = 0;
+    uint32_t restarts = 0;
+};
@@ -0,0 +1,79 @@
+#include "speedgears.h"
+
+#include "fixedmapping.h"
+
+SpeedGearTable::SpeedGearTable()
+{
+    for (int i = 0; i < SpeedGearMax; i++) {
+        for (int j = 0; j < MappingWidth; j++) {
+            gain[i][j] = 1;
+        }
+    }
+}
+
+void SpeedGears::Configure(const SpeedGearTable& table)
+{
+    this->table = table;
+    if (this->table.count < 1) {
+        this->table.count = 1;
+    }
+    if (this->table.count > SpeedGearMax) {
+        this->table.count = SpeedGearMax;
+    }
+    Reset();
+}
+
+void SpeedGears::Reset()
+{
+    current = -1;
+    Select(table.initial);
+}
+
+bool SpeedGears::Select(int gear)
+{
+    if (gear < 0) {
+        gear = 0;
+    }
+    if (gear >= table.count) {
+        gear = table.count - 1;
+    }
+    if (gear == current) {
+        return false;
+    }
+    current = gear;
+    Apply();
+    return true;
+}
+
+bool SpeedGears::Shift(int delta)
+{
+    return Select(current + delta);
+}
+
+int SpeedGears::Current() const
+{
+    return current;
+}
+
+int SpeedGears::Count() const
+{
+    return table.count;
+}
+
+const float* SpeedGears::Scale() const
+{
+    return scale;
+}
+
+const int32_t* SpeedGears::ScaleFixed() const
+{
+    return scaleFixed;
+}
+
+void SpeedGears::Apply()
+{
+    for (int i = 0; i < MappingWidth; i++) {
+        scale[i] = table.gain[current][i];
+        scaleFixed[i] = ToQ16(scale[i]);
+    }
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+
+#include "mapping.h"
+
+const int SpeedGearMax = 8;
+
+// Таблица передач: коэффициент на каждую степень свободы
+struct SpeedGearTable
+{
+    int count = 1;
+    int initial = 0;
+    float gain[SpeedGearMax][MappingWidth];
+
+    SpeedGearTable();
+};
+
+// Передача хранится до явного переключения. Строка коэффициентов текущей
+// передачи готовится при переключении, такт только умножает на нее.
+class SpeedGears
+{
+public:
+    void Configure(const SpeedGearTable& table);
+    void Reset();
+
+    // Возвращают true, если передача сменилась
+    bool Select(int gear);
+    bool Shift(int delta);
+
+    int Current() const;
+    int Count() const;
+
+    const float* Scale() const;
+    const int32_t* ScaleFixed() const;
+
+private:
+    void Apply();
+
+    SpeedGearTable table;
+    int current = 0;
+
+    alignas(32) float scale[MappingWidth];
+    int32_t scaleFixed[MappingWidth];
+};
@@ -0,0 +1,218 @@
+#pragma once
+
+#include <ratio>
+
+#include "commanddispatch.h"
+#include "mapping.h"
+
+// Привязки, заданные типом, для неизменных конфигураций аппарата.
+// Набор BindingSet<...> разворачивается компилятором в линейный код без
+// std::function и без обращения к таблицам: каждая привязка проверяет свой
+// бит маски и пишет свой слот. Descriptors/BuildMapping дают те же привязки
+// в виде таблиц времени выполнения для сверки.
+
+template <typename Ratio>
+inline float RatioValue()
+{
+    return static_cast<float>(Ratio::num) / static_cast<float>(Ratio::den);
+}
+
+// Команда кнопки: действие и значение (коэффициент скорости) как std::ratio
+template <CommandAction::Enum Action, int Button, typename Value = std::ratio<0>>
+struct ButtonBinding
+{
+    static CommandDescriptor Descriptor()
+    {
+        CommandDescriptor descriptor;
+        descriptor.action = Action;
+        descriptor.trigger = CommandTrigger::Button;
+        descriptor.binding = Button;
+        descriptor.sample = AxisSample::Last;
+        descriptor.slot = -1;
+        descriptor.value = RatioValue<Value>();
+        descriptor.gain = 1;
+        descriptor.expo = 0;
+        descriptor.type = motion::ControlType::Force;
+        descriptor.frame = scene::Absent;
+        descriptor.layer = 0;
+        descriptor.target = -1;
+        descriptor.expression = -1;
+        return descriptor;
+    }
+
+    template <typename Executor>
+    static void Dispatch(const DispatchMask& mask, Executor& execute)
+    {
+        const uint32_t bit = 1u << Button;
+        if (mask.pressed & bit) {
+            execute(Descriptor(), true);
+        }
+        if (mask.released & bit) {
+            execute(Descriptor(), false);
+        }
+    }
+
+    static void Map(const float*, const float*, MappedControl&) {}
+    static void AddTo(CommandTable& table) { table.Add(Descriptor()); }
+    static void AddTo(MappingTable&) {}
+};
+
+// Ось на степень свободы: value[Slot] = Gain * scale * curve(input), curve с долей куба Expo
+template <geo::Axis Slot, int Axis, AxisSample Sample, typename Gain, typename Expo = std::ratio<0>,
+          motion::ControlType::Enum Type = motion::ControlType::Velocity, scene::Object Frame = scene::Absent>
+struct AxisBinding
+{
+    static CommandDescriptor Descriptor()
+    {
+        CommandDescriptor descriptor;
+        descriptor.action = CommandAction::Move;
+        descriptor.trigger = CommandTrigger::Axis;
+        descriptor.binding = Axis;
+        descriptor.sample = Sample;
+        descriptor.slot = Slot;
+        descriptor.value = 0;
+        descriptor.gain = RatioValue<Gain>();
+        descriptor.expo = RatioValue<Expo>();
+        descriptor.type = Type;
+        descriptor.frame = Frame;
+        descriptor.layer = 0;
+        descriptor.target = -1;
+        descriptor.expression = -1;
+        return descriptor;
+    }
+
+    template <typename Executor>
+    static void Dispatch(const DispatchMask&, Executor&) {}
+
+    static void Map(const float* input, const float* scale, MappedControl& out)
+    {
+        const float x = input[static_cast<int>(Sample) * MappingAxisCount + Axis];
+        const float e = RatioValue<Expo>();
+        const float curve = x * (1.0f - e) + e * x * x * x;
+        out.value[Slot] += RatioValue<Gain>() * scale[Slot] * curve;
+        out.activeMask |= (x != 0.0f ? 1u : 0u) << Slot;
+    }
+
+    static void AddTo(CommandTable& table) { table.Add(Descriptor()); }
+    static void AddTo(MappingTable& mapping)
+    {
+        BindMappingAxis(mapping, Slot, MappingSourceIndex(Axis, Sample), RatioValue<Gain>(), RatioValue<Expo>(),
+                        Type, Frame);
+    }
+};
+
+// Постоянное задание степени свободы
+template <geo::Axis Slot, typename Value,
+          motion::ControlType::Enum Type = motion::ControlType::Force, scene::Object Frame = scene::Absent>
+struct ConstantBinding
+{
+    static CommandDescriptor Descriptor()
+    {
+        CommandDescriptor descriptor;
+        descriptor.action = CommandAction::Hold;
+        descriptor.trigger = CommandTrigger::None;
+        descriptor.binding = -1;
+        descriptor.sample = AxisSample::Last;
+        descriptor.slot = Slot;
+        descriptor.value = RatioValue<Value>();
+        descriptor.gain = 1;
+        descriptor.expo = 0;
+        descriptor.type = Type;
+        descriptor.frame = Frame;
+        descriptor.layer = 0;
+        descriptor.target = -1;
+        descriptor.expression = -1;
+        return descriptor;
+    }
+
+    template <typename Executor>
+    static void Dispatch(const DispatchMask&, Executor&) {}
+
+    static void Map(const float*, const float*, MappedControl& out)
+    {
+        out.value[Slot] += RatioValue<Value>();
+    }
+
+    static void AddTo(CommandTable& table) { table.Add(Descriptor()); }
+    static void AddTo(MappingTable& mapping)
+    {
+        BindMappingConstant(mapping, Slot, RatioValue<Value>(), Type, Frame);
+    }
+};
+
+template <typename... Bindings>
+struct BindingSet;
+
+template <>
+struct BindingSet<>
+{
+    template <typename Executor>
+    static void DispatchAll(const DispatchMask&, Executor&) {}
+    static void MapAll(const float*, const float*, MappedControl&) {}
+    static void AddAll(CommandTable&) {}
+    static void AddAll(MappingTable&) {}
+};
+
+template <typename First, typename... Rest>
+struct BindingSet<First, Rest...>
+{
+    template <typename Executor>
+    static void DispatchAll(const DispatchMask& mask, Executor& execute)
+    {
+        First::Dispatch(mask, execute);
+        BindingSet<Rest...>::DispatchAll(mask, execute);
+    }
+
+    static void MapAll(const float* input, const float* scale, MappedControl& out)
+    {
+        First::Map(input, scale, out);
+        BindingSet<Rest...>::MapAll(input, scale, out);
+    }
+
+    static void AddAll(CommandTable& table)
+    {
+        First::AddTo(table);
+        BindingSet<Rest...>::AddAll(table);
+    }
+
+    static void AddAll(MappingTable& mapping)
+    {
+        First::AddTo(mapping);
+        BindingSet<Rest...>::AddAll(mapping);
+    }
+};
+
+// Точки входа для набора привязок Set
+template <typename Set>
+struct StaticBindings
+{
+    template <typename Executor>
+    static void Dispatch(const DispatchMask& mask, Executor&& execute)
+    {
+        if ((mask.pressed | mask.released) == 0) {
+            return;
+        }
+        Set::DispatchAll(mask, execute);
+    }
+
+    static void Map(const float* input, const float* scale, MappedControl& out)
+    {
+        for (int i = 0; i < MappingWidth; i++) {
+            out.value[i] = 0;
+        }
+        out.activeMask = 0;
+        Set::MapAll(input, scale, out);
+    }
+
+    static void Descriptors(CommandTable& table)
+    {
+        table.Clear();
+        Set::AddAll(table);
+    }
+
+    static void BuildMapping(MappingTable& mapping)
+    {
+        ClearMapping(mapping);
+        Set::AddAll(mapping);
+    }
+};
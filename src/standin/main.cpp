@@ -0,0 +1,15 @@
+#include "vehicle.h"
+
+int main(int argc, char *argv[])
+{
+    ipc::Core::Description appDescription;
+    appDescription._title       = "Заменитель аппарата";
+    appDescription._version     = "1.0";
+    appDescription._description = "Принимает команды драйвера джойстика и замеряет задержки";
+
+    ipc::Core core(argc, argv, appDescription);
+    Vehicle vehicle(core);
+    vehicle.Run();
+
+    return 0;
+}
@@ -0,0 +1,37 @@
+TEMPLATE = app
+CONFIG += console c++11
+CONFIG -= app_bundle                 # Не собирать маковский архив
+CONFIG -= qt
+QT -= gui
+QT -= core
+DESTDIR = ../../bin                  # Папка с бинарниками проекта
+OBJECTS_DIR = $$PWD/build            # Путь объектников
+TARGET = standin
+
+SOURCES += \
+    main.cpp \
+    vehicle.cpp \
+    ../driver/controlbundle.cpp \
+    ../driver/controldedup.cpp \
+    ../driver/controlframe.cpp \
+    ../driver/sequencetracker.cpp
+
+HEADERS += \
+    standinmessages.h \
+    vehicle.h
+
+win32 {
+    # Путь до библиотеки IPC:
+    IPC_LIB_PATH = "..\..\lib\ipc_lib\win32\usr"
+}
+
+linux-g++ {
+    # Путь до библиотеки IPC:
+    IPC_LIB_PATH = "..\..\lib\ipc_lib\linux\usr"
+}
+
+INCLUDEPATH += \
+    ..\driver \
+    $${IPC_LIB_PATH}\include
+LIBS += \
+    -L$${IPC_LIB_PATH}\lib -lipc
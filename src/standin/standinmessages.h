@@ -0,0 +1,28 @@
+#pragma once                  // Только один раз подключаем заголовочник
+#include "ipc.h"
+#pragma pack(push,1)          // Выставляем однобайтовое выравнивание!!!
+
+namespace Message {
+    // Настройки стенда: искусственные потери на приеме, по пути отдельно,
+    // задержка и ограниченная скорость разбора команд
+    struct StandinInit {
+        double drop_bus;
+        double drop_udp;
+        double delay;
+        double consume_rate;
+        ipc::Schema schema() {
+            return ipc::Schema(this).title("Настройки заменителя аппарата")
+               .add(IPC_REAL(drop_bus).title("Доля команд, теряемых на шине")
+                    .minimum(0.0).maximum(1.0).default_(0.0))
+               .add(IPC_REAL(drop_udp).title("Доля команд, теряемых на UDP")
+                    .minimum(0.0).maximum(1.0).default_(0.0))
+               .add(IPC_REAL(delay).title("Задержка команды до разбора")
+                    .unit("c").minimum(0.0).default_(0.0))
+               .add(IPC_REAL(consume_rate).title("Разбор команд, 0 - без ограничения")
+                    .unit("1/c").minimum(0.0).default_(0.0))
+               ;
+        }
+    };
+}
+
+#pragma pack(pop)
@@ -0,0 +1,292 @@
+#include "vehicle.h"
+#include "monotonic.h"
+
+#include <algorithm>
+#include <cstdio>
+
+static const double ForceGain = 100.0;       // Н или Н*м на единицу команды
+static const double ForceLimit = 1000.0;
+
+void LatencyWindow::Add(uint64_t latency)
+{
+    count++;
+    sum += latency;
+    if (latency > max) {
+        max = latency;
+    }
+}
+
+void LatencyWindow::Reset()
+{
+    count = 0;
+    sum = 0;
+    max = 0;
+}
+
+double LatencyWindow::Mean() const
+{
+    return count > 0 ? static_cast<double>(sum) / count : 0.0;
+}
+
+Vehicle::Vehicle(ipc::Core& core)
+    : core(core)
+    , settings(core)
+    , standinSettings(core)
+    , udpReceiver(core, static_cast<uint16_t>(settings._.udp_port))
+    , bundleReceiver(core)
+    , controlReceiver(core)
+    , controlStampReceiver(core)
+    , stateReceiver(core)
+    , diagnosticsSender(core)
+    , ackSender(core)
+    , workSender(core)
+    , forcesSender(core)
+{
+}
+
+void Vehicle::Run()
+{
+    ipc::Timer reportTimer(core);
+    ipc::Timer expireTimer(core);
+    ipc::Timer releaseTimer(core);
+    reportTimer.start(1.0);
+    expireTimer.start(0.05);
+    releaseTimer.start(0.002);
+
+    while (core.receive()) {
+        if (bundleReceiver.received()) {
+            OnBundle();
+            continue;
+        }
+        if (controlReceiver.received()) {
+            busControl = controlReceiver._;
+            busControlFresh = true;
+            continue;
+        }
+        if (controlStampReceiver.received()) {
+            OnControlStamp();
+            continue;
+        }
+        if (udpReceiver.received()) {
+            OnControlFrame();
+            continue;
+        }
+        if (stateReceiver.received()) {
+            stateTracker.Receive(stateReceiver._.stamp);
+            continue;
+        }
+        if (releaseTimer.received()) {
+            ReleaseDelayed();
+            continue;
+        }
+        if (expireTimer.received()) {
+            ExpireControl();
+            continue;
+        }
+        if (reportTimer.received()) {
+            Report();
+            PublishDiagnostics();
+            continue;
+        }
+    }
+}
+
+void Vehicle::OnBundle()
+{
+    bundles++;
+    bundleTracker.Receive(bundleReceiver._.stamp);
+    uint64_t now = MonotonicMicroseconds();
+    unbundler.Unpack(bundleReceiver._, [this, now](const motion::Control&, uint64_t timestamp) {
+        sampleLatency.Add(now > timestamp ? now - timestamp : 0);
+    });
+}
+
+// Метка идет по шине сразу за motion::Control и представляет его копию. Метка без
+// новой команды или с чужой контрольной суммой - потеря копии по шине: иначе прежняя
+// команда ушла бы под новым номером и вытеснила верную копию по UDP
+void Vehicle::OnControlStamp()
+{
+    const Message::ControlStamp& controlStamp = controlStampReceiver._;
+    bool paired = busControlFresh && ControlChecksum(busControl) == controlStamp.checksum;
+    busControlFresh = false;
+    if (!paired) {
+        unpairedStamps++;
+        return;
+    }
+    OnControl(ControlDedup::Bus, controlStamp.stamp.sequence, controlStamp.stamp.timestamp, busControl);
+}
+
+void Vehicle::OnControlFrame()
+{
+    const std::vector<char>& data = udpReceiver.datagram().data;
+    ControlFrameHeader header;
+    if (!DecodeControlFrame(reinterpret_cast<const uint8_t*>(data.data()), data.size(), udpControl, header)) {
+        badFrames++;
+        return;
+    }
+    OnControl(ControlDedup::Udp, header.sequence, header.timestamp, udpControl);
+}
+
+void Vehicle::OnControl(ControlDedup::Path path, uint32_t sequence, uint64_t timestamp, const motion::Control& control)
+{
+    const Message::StandinInit& injected = standinSettings._;
+    double drop = path == ControlDedup::Bus ? injected.drop_bus : injected.drop_udp;
+    if (drop > 0 && chance(random) < drop) {
+        return;
+    }
+
+    Arrival arrival;
+    arrival.path = path;
+    arrival.sequence = sequence;
+    arrival.timestamp = timestamp;
+    arrival.due = MonotonicMicroseconds() + static_cast<uint64_t>(injected.delay * 1e6);
+    arrival.control = control;
+    if (injected.delay <= 0 && injected.consume_rate <= 0 && delayCount == 0) {
+        Consume(arrival);
+        return;
+    }
+    if (delayCount == DelayLineCapacity) {
+        overflows++;
+        return;
+    }
+    delayLine[(delayHead + delayCount) % DelayLineCapacity] = arrival;
+    delayCount++;
+}
+
+// Команды выходят из линии по сроку и не чаще consume_rate; просроченные ждущие - очередь получателя
+void Vehicle::ReleaseDelayed()
+{
+    uint64_t now = MonotonicMicroseconds();
+    double rate = standinSettings._.consume_rate;
+    while (delayCount > 0 && delayLine[delayHead].due <= now && (rate <= 0 || now >= nextConsume)) {
+        Consume(delayLine[delayHead]);
+        delayHead = (delayHead + 1) % DelayLineCapacity;
+        delayCount--;
+        if (rate > 0) {
+            nextConsume = now + static_cast<uint64_t>(1e6 / rate);
+        }
+    }
+    int overdue = 0;
+    for (int i = 0; i < delayCount && delayLine[(delayHead + i) % DelayLineCapacity].due <= now; i++) {
+        overdue++;
+    }
+    queueMax = std::max(queueMax, overdue);
+}
+
+void Vehicle::Consume(const Arrival& arrival)
+{
+    uint64_t now = MonotonicMicroseconds();
+    uint64_t elapsed = now > arrival.timestamp ? now - arrival.timestamp : 0;
+    (arrival.path == ControlDedup::Bus ? busLatency : udpLatency).Add(elapsed);
+    if (dedup.Accept(arrival.path, arrival.sequence, arrival.timestamp)) {
+        deliveredLatency.Add(elapsed);
+        Apply(arrival.control);
+    }
+
+    // Подтверждается и повтор: первое подтверждение могло потеряться.
+    // Время отправки возвращается, чтобы отправитель считал RTT без своей таблицы.
+    Message::ControlAck& ack = ackSender._;
+    ack.stamp.sequence = ++ackSequence;
+    ack.stamp.timestamp = now;
+    ack.sequence = arrival.sequence;
+    ack.sent = arrival.timestamp;
+    ackSender.send();
+}
+
+// Грубая модель модуля движения: сила пропорциональна команде по каждой степени свободы
+void Vehicle::Apply(const motion::Control& control)
+{
+    motion::Forces& forces = forcesSender._;
+    for (int i = 0; i < geo::Num; i++) {
+        double force = control.parameters[i].value * ForceGain;
+        forces.unlimit[i] = force;
+        forces.limit[i] = std::max(-ForceLimit, std::min(ForceLimit, force));
+    }
+    forcesSender.send();
+    workSender._.priority = control.priority;
+    workSender.send();
+    appliedTime = MonotonicMicroseconds();
+    timeLimit = control.time_limit;
+}
+
+void Vehicle::ExpireControl()
+{
+    if (appliedTime == 0 || MonotonicMicroseconds() - appliedTime < static_cast<uint64_t>(timeLimit * 1e6)) {
+        return;
+    }
+    // Сначала Work: обнуление сил по истечении time_limit - не отклик на команду
+    workSender._.priority = motion::Priority::NoControl;
+    workSender.send();
+    motion::Forces& forces = forcesSender._;
+    for (int i = 0; i < geo::Num; i++) {
+        forces.limit[i] = 0;
+        forces.unlimit[i] = 0;
+    }
+    forcesSender.send();
+    appliedTime = 0;
+}
+
+// Задержки путей печатаются рядом: та же машина, те же часы
+static void PrintPath(const char* name, const LatencyWindow& latency, const SequenceTracker& tracker)
+{
+    if (latency.count == 0) {
+        return;
+    }
+    std::printf("%-4s %5llu/s  latency mean %8.1f us  max %8llu us  lost %u reordered %u duplicates %u\n",
+                name, static_cast<unsigned long long>(latency.count), latency.Mean(),
+                static_cast<unsigned long long>(latency.max), tracker.Lost(), tracker.Reordered(),
+                tracker.Duplicates());
+}
+
+void Vehicle::Report()
+{
+    if (bundles > 0) {
+        std::printf("bundles %4u/s  samples %5llu/s  latency mean %8.1f us  max %8llu us  lost %u\n",
+                    bundles, static_cast<unsigned long long>(sampleLatency.count), sampleLatency.Mean(),
+                    static_cast<unsigned long long>(sampleLatency.max), unbundler.LostBundles());
+    }
+    bundles = 0;
+    sampleLatency.Reset();
+
+    PrintPath("bus", busLatency, dedup.Arrived(ControlDedup::Bus));
+    PrintPath("udp", udpLatency, dedup.Arrived(ControlDedup::Udp));
+    if (busLatency.count > 0 && udpLatency.count > 0) {
+        const SequenceTracker& merged = dedup.Merged();
+        std::printf("both %5llu/s  latency mean %8.1f us  max %8llu us  loss %.4f (bus %.4f, udp %.4f)  "
+                    "first: bus %u udp %u late %u\n",
+                    static_cast<unsigned long long>(deliveredLatency.count), deliveredLatency.Mean(),
+                    static_cast<unsigned long long>(deliveredLatency.max), merged.LossRate(),
+                    dedup.Arrived(ControlDedup::Bus).LossRate(), dedup.Arrived(ControlDedup::Udp).LossRate(),
+                    dedup.Wins(ControlDedup::Bus), dedup.Wins(ControlDedup::Udp), dedup.Late());
+    }
+    if (badFrames > 0) {
+        std::printf("udp  %u frames rejected\n", badFrames);
+    }
+    if (unpairedStamps > 0) {
+        std::printf("bus  %u stamps without their command\n", unpairedStamps);
+    }
+    if (overflows > 0) {
+        std::printf("delay line full, %u commands dropped\n", overflows);
+    }
+    busLatency.Reset();
+    udpLatency.Reset();
+    deliveredLatency.Reset();
+    badFrames = 0;
+    unpairedStamps = 0;
+    overflows = 0;
+}
+
+void Vehicle::PublishDiagnostics()
+{
+    Message::LinkDiagnostics& diagnostics = diagnosticsSender._;
+    diagnostics.stamp.sequence = ++diagnosticsSequence;
+    diagnostics.stamp.timestamp = MonotonicMicroseconds();
+    dedup.Arrived(ControlDedup::Bus).Fill(diagnostics.control);
+    dedup.Arrived(ControlDedup::Udp).Fill(diagnostics.udp);
+    dedup.Merged().Fill(diagnostics.delivered);
+    bundleTracker.Fill(diagnostics.bundle);
+    stateTracker.Fill(diagnostics.state);
+    diagnostics.queue_depth = queueMax;
+    queueMax = 0;
+    diagnosticsSender.send();
+}
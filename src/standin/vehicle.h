@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+
+#include "ipc.h"
+#include "controlbundle.h"
+#include "controldedup.h"
+#include "controlframe.h"
+#include "messages.h"
+#include "sequencetracker.h"
+#include "standinmessages.h"
+
+// Копия команды, ждущая разбора в линии задержки
+struct Arrival
+{
+    ControlDedup::Path path;
+    uint32_t sequence;
+    uint64_t timestamp;
+    uint64_t due;                     // Когда разобрать, мкс
+    motion::Control control;
+};
+
+const int DelayLineCapacity = 256;
+
+// Задержки за период отчета, мкс
+struct LatencyWindow
+{
+    void Add(uint64_t latency);
+    void Reset();
+    double Mean() const;
+
+    uint64_t count = 0;
+    uint64_t sum = 0;
+    uint64_t max = 0;
+};
+
+// Стенд вместо аппарата: принимает то, что шлет драйвер, разбирает так же,
+// как должен разбирать аппарат, и раз в секунду печатает задержки и потери
+// и публикует диагностику доставки.
+// Метки времени драйвера монотонные, поэтому стенд запускается на той же машине.
+// Команда с шины и с UDP сводится по номеру: потребителю уходит первая копия,
+// потери, задержку и медленный разбор можно добавить искусственно (Message::StandinInit).
+// На каждую принятую копию команды стенд отвечает Message::ControlAck вместо модуля движения.
+// Первая копия сразу переводится в motion::Forces и motion::Work, как это делал бы
+// модуль движения; по истечении time_limit силы сбрасываются.
+class Vehicle
+{
+public:
+    explicit Vehicle(ipc::Core& core);
+
+    void Run();
+
+private:
+    void OnBundle();
+    void OnControlStamp();
+    void OnControlFrame();
+    void OnControl(ControlDedup::Path path, uint32_t sequence, uint64_t timestamp, const motion::Control& control);
+    void Consume(const Arrival& arrival);
+    void ReleaseDelayed();
+    void Apply(const motion::Control& control);
+    void ExpireControl();
+    void Report();
+    void PublishDiagnostics();
+
+    ipc::Core& core;
+    ipc::Loader<Message::Init> settings;  // Порт UDP - из настроек драйвера
+    ipc::Loader<Message::StandinInit> standinSettings;
+    ipc::UdpSocketReceiver udpReceiver;
+    ipc::Receiver<Message::ControlBundle> bundleReceiver;
+    ipc::Receiver<motion::Control> controlReceiver;
+    ipc::Receiver<Message::ControlStamp> controlStampReceiver;
+    ipc::Receiver<Message::State> stateReceiver;
+    ipc::Sender<Message::LinkDiagnostics> diagnosticsSender;
+    ipc::Sender<Message::ControlAck> ackSender;
+    ipc::Sender<motion::Work> workSender;
+    ipc::Sender<motion::Forces> forcesSender;
+    ControlUnbundler unbundler;
+
+    // Доставка по меткам отправки: накапливается за все время работы стенда
+    ControlDedup dedup;
+    SequenceTracker bundleTracker;
+    SequenceTracker stateTracker;
+    uint32_t diagnosticsSequence = 0;
+    uint32_t ackSequence = 0;
+
+    uint32_t bundles = 0;
+    LatencyWindow sampleLatency;      // От снятия отсчета до разбора пакета
+    LatencyWindow busLatency;         // От отправки команды до приема, по шине
+    LatencyWindow udpLatency;         // То же, напрямую по UDP
+    LatencyWindow deliveredLatency;   // Первая копия после сведения путей
+    std::minstd_rand random;
+    std::uniform_real_distribution<double> chance{0.0, 1.0};
+    motion::Control busControl;       // Пришла по шине, ждет своей метки
+    bool busControlFresh = false;     // busControl еще не отдан метке
+    motion::Control udpControl;
+    uint64_t appliedTime = 0;         // Когда применена последняя команда, 0 - сил нет
+    double timeLimit = 0;
+    uint32_t badFrames = 0;
+    uint32_t unpairedStamps = 0;
+
+    // Линия задержки: очередь разбора, глубина просроченной части уходит в диагностику
+    Arrival delayLine[DelayLineCapacity];
+    int delayHead = 0;
+    int delayCount = 0;
+    uint64_t nextConsume = 0;
+    int queueMax = 0;
+    uint32_t overflows = 0;
+};
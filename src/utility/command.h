@@ -5,6 +5,6 @@
 class Command {
  public:
     QString title;
-    QString commandName;
+    int entryIndex;     // Номер записи в массиве commands
     QString buttonMapping;
 };
@@ -199,20 +199,35 @@ void Controller::LoadControlSettings(const QString &filename)
 
     file.close();
 
-    const QJsonObject& buttonCommandsJSON = objectJSON["button_commands"].toObject();
-    for (const auto& key : buttonCommandsJSON.keys()) {
-        const QJsonObject& commandJSON = buttonCommandsJSON[key].toObject();
-        QString title = commandJSON["title"].toString();
-        QString binding = commandJSON["binding"].toString();
-        buttonCommands.push_back({title, key, binding});
+    // Команды слоев подписываются названием слоя
+    QMap<QString, QString> layerTitles;
+    const QJsonArray& layersJSON = objectJSON["layers"].toArray();
+    for (int i = 0; i < layersJSON.size(); i++) {
+        const QJsonObject& layerJSON = layersJSON[i].toObject();
+        QString name = layerJSON["name"].toString();
+        layerTitles[name] = layerJSON["title"].toString(name);
     }
 
-    const auto& axesCommandsJSON = objectJSON["axis_commands"].toObject();
-    for (const auto& key : axesCommandsJSON.keys()) {
-        const auto& commandJSON = axesCommandsJSON[key].toObject();
+    const QJsonArray& commandsJSON = objectJSON["commands"].toArray();
+    for (int i = 0; i < commandsJSON.size(); i++) {
+        const QJsonObject& commandJSON = commandsJSON[i].toObject();
         QString title = commandJSON["title"].toString();
+        QString layer = commandJSON["layer"].toString();
+        if (!layer.isEmpty() && layer != "base") {
+            title = "[" + layerTitles.value(layer, layer) + "] " + title;
+        }
         QString binding = commandJSON["binding"].toString();
-        axisCommands.push_back({title, key, binding});
+        QString trigger = commandJSON["trigger"].toString();
+        // Постоянные задания не привязаны к кнопкам и осям
+        if (trigger == "none") {
+            continue;
+        }
+        if (trigger == "axis") {
+            axisCommands.push_back({title, i, binding});
+        }
+        else {
+            buttonCommands.push_back({title, i, binding});
+        }
     }
 }
 
@@ -235,21 +250,18 @@ void Controller::SaveControlSettings(const QString& filename)
     // Получение корневого JSON-объекта из JSON-документа
     QJsonObject objectJSON = document.object();
 
-    QJsonObject buttonCommandsJSON = objectJSON["button_commands"].toObject();
+    QJsonArray commandsJSON = objectJSON["commands"].toArray();
     for (const auto& command : buttonCommands) {
-        QJsonObject commandJSON = buttonCommandsJSON[command.commandName].toObject();
+        QJsonObject commandJSON = commandsJSON[command.entryIndex].toObject();
         commandJSON["binding"] = command.buttonMapping;
-        buttonCommandsJSON[command.commandName] = commandJSON;
+        commandsJSON[command.entryIndex] = commandJSON;
     }
-    objectJSON["button_commands"] = buttonCommandsJSON;
-
-    QJsonObject axesCommandsJSON = objectJSON["axis_commands"].toObject();
     for (const auto& command : axisCommands) {
-        QJsonObject commandJSON = axesCommandsJSON[command.commandName].toObject();
+        QJsonObject commandJSON = commandsJSON[command.entryIndex].toObject();
         commandJSON["binding"] = command.buttonMapping;
-        axesCommandsJSON[command.commandName] = commandJSON;
+        commandsJSON[command.entryIndex] = commandJSON;
     }
-    objectJSON["axis_commands"] = axesCommandsJSON;
+    objectJSON["commands"] = commandsJSON;
 
     document.setObject(objectJSON);
 
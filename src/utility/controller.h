@@ -2,8 +2,10 @@
 
 #include <QObject>
 #include <QFile>
+#include <QJsonArray>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QMap>
 #include <QDebug>
 #include <QTimer>
 